@@ -42,13 +42,18 @@
 #define configUSE_PREEMPTION					1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
 #define configUSE_IDLE_HOOK						0
-#define configUSE_TICK_HOOK						0
+#define configUSE_TICK_HOOK						1 /* Counts ticks for the wakeup accounting panel. */
 #define configUSE_DAEMON_TASK_STARTUP_HOOK		0
 #define configTICK_RATE_HZ						( 1000 ) /* In this non-real time simulated environment the tick frequency has to be at least a multiple of the Win32 tick frequency, and therefore very slow. */
 #define configMINIMAL_STACK_SIZE				( ( unsigned short ) 70 ) /* In this simulated case, the stack only has to hold one small structure as the real stack is part of the win32 thread. */
 #define configTOTAL_HEAP_SIZE					( ( size_t ) ( 49 * 1024 ) ) /* This demo tests heap_5 so places multiple blocks within this total heap size.  See mainREGION_1_SIZE to mainREGION_3_SIZE definitions in main.c. */
 #define configMAX_TASK_NAME_LEN					( 12 )
-#define configUSE_TRACE_FACILITY				0
+/* Percepio trace recorder, off by default. Add PLANT_MONITOR_TRACE=1 to the
+preprocessor definitions to record kernel and pipeline events, see trace_events.hpp. */
+#ifndef PLANT_MONITOR_TRACE
+	#define PLANT_MONITOR_TRACE				0
+#endif
+#define configUSE_TRACE_FACILITY				PLANT_MONITOR_TRACE
 #define configUSE_16_BIT_TICKS					0
 #define configIDLE_SHOULD_YIELD					1
 #define configUSE_MUTEXES						1
@@ -112,6 +117,44 @@ functions anyway. */
  * time. */
 #define configRUN_ADDITIONAL_TESTS				1
 
+/* Tickless idle, on unless PLANT_MONITOR_TICKLESS=0 is defined. The Win32 port
+has no tick suppression of its own, so the simulation supplies one that parks
+the idle thread for the expected idle time. The simulated tick keeps running,
+ticks that arrive during that sleep are the ones a tickless port would skip
+and the wakeup accounting panel reports them separately. */
+#ifndef PLANT_MONITOR_TICKLESS
+	#define PLANT_MONITOR_TICKLESS				1
+#endif
+#define configUSE_TICKLESS_IDLE					PLANT_MONITOR_TICKLESS
+#if ( configUSE_TICKLESS_IDLE == 1 ) && defined( _WIN32 )
+	void vSimulatedSuppressTicksAndSleep( unsigned long ulExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vSimulatedSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+
+/* Virtual time for soak runs, off unless PLANT_MONITOR_VIRTUAL_TIME=1 is
+defined. The tickless idle hook then steps the tick count over each idle period
+instead of sleeping through it, so simulated time advances as fast as the tasks
+can run. The run ends after SOAK_DURATION with a statistics report, see main.cpp. */
+#ifndef PLANT_MONITOR_VIRTUAL_TIME
+	#define PLANT_MONITOR_VIRTUAL_TIME			0
+#endif
+#if ( PLANT_MONITOR_VIRTUAL_TIME == 1 ) && ( configUSE_TICKLESS_IDLE != 1 )
+	#error PLANT_MONITOR_VIRTUAL_TIME needs tickless idle, PLANT_MONITOR_TICKLESS must not be 0
+#endif
+
+/* Wakeup accounting hook, see wakeup_accounting.hpp, and a count of the bytes and
+blocks the kernel allocates and of the blocks it frees for the soak report. heap_3
+passes no size to traceFREE, so freed bytes are not known. The trace recorder takes over these
+hooks in PLANT_MONITOR_TRACE builds, its snapshot then holds the same information. */
+#if ( configUSE_TRACE_FACILITY != 1 )
+	void vWakeupAccountingSwitchedIn( void * pvTask );
+	#define traceTASK_SWITCHED_IN() vWakeupAccountingSwitchedIn( ( void * ) pxCurrentTCB )
+	void vHeapAccountingMalloc( void * pvAddress, size_t xSize );
+	#define traceMALLOC( pvAddress, uiSize ) vHeapAccountingMalloc( pvAddress, uiSize )
+	void vHeapAccountingFree( void * pvAddress );
+	#define traceFREE( pvAddress, uiSize ) vHeapAccountingFree( pvAddress )
+#endif
+
 /* It is a good idea to define configASSERT() while developing.  configASSERT()
 uses the same semantics as the standard C assert() macro. */
 extern void vAssertCalled( unsigned long ulLine, const char * const pcFileName );
@@ -123,4 +166,10 @@ extern void vAssertCalled( unsigned long ulLine, const char * const pcFileName )
 	#define sbSEND_COMPLETED( pxStreamBuffer ) vGenerateCoreBInterrupt( pxStreamBuffer )
 #endif /* configINCLUDE_MESSAGE_BUFFER_AMP_DEMO */
 
+/* The recorder hooks the trace macros, so it must be included after every other
+definition in this file. */
+#if ( configUSE_TRACE_FACILITY == 1 )
+	#include "trcRecorder.h"
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
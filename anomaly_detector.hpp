@@ -0,0 +1,127 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+/*
+* @brief: Per sensor thresholds for AnomalyDetector.
+*/
+struct AnomalyConfig {
+    float z_threshold;     // |x - mean| / stddev above this is a spike
+    float cusum_drift;     // slack k in stddevs, shifts smaller than this never accumulate
+    float cusum_threshold; // decision level h in stddevs, accumulated shift above this is a level change
+    float min_stddev;      // floor for stddev so a near constant signal doesn't turn noise into alerts
+    uint32_t warmup;       // samples to learn from before raising anything
+    uint32_t spike_run;    // consecutive same sign spikes after which they count towards a level change
+};
+
+/*
+* @brief: AnomalyDetector is an O(1) per sample streaming detector. Welford's algorithm keeps a running mean and variance,
+* a sample too many stddevs out is a SPIKE (e.g. watering). A two sided CUSUM on the standardized residual catches
+* sustained level changes that never trip the z-score (e.g. a failing probe drifting off).
+* Spikes are left out of the running statistics so a single outlier doesn't widen the band for the next one,
+* after a level change the statistics restart so the detector follows the new baseline.
+* A step larger than the spike threshold would otherwise report SPIKE forever: once spike_run spikes in a row point
+* the same way, each further one feeds CUSUM with its z clamped to the threshold, which then reports the shift.
+* The per sample cost is a sqrtf, a division and a few compares, tools/bench_anomaly.cpp sets it against the filter and digest.
+*/
+class AnomalyDetector {
+public:
+    enum class Kind { NONE, SPIKE, SHIFT_UP, SHIFT_DOWN };
+
+    struct Result {
+        Kind kind;
+        float score; // z-score for SPIKE, CUSUM statistic for SHIFT_*
+    };
+
+    explicit AnomalyDetector(const AnomalyConfig& config = { 4.0f, 0.5f, 8.0f, 0.01f, 20, 3 }) : m_config(config) {}
+
+    void configure(const AnomalyConfig& config) {
+        m_config = config;
+    }
+
+    Result update(float x) {
+        if (m_count < m_config.warmup || m_count < 2) {
+            learn(x);
+            return { Kind::NONE, 0.0f };
+        }
+
+        float stddev = sqrtf(m_m2 / static_cast<float>(m_count - 1));
+        if (stddev < m_config.min_stddev) {
+            stddev = m_config.min_stddev;
+        }
+        float z = (x - m_mean) / stddev;
+
+        if (fabsf(z) > m_config.z_threshold) {
+            // a run only continues while the spikes keep their sign, alternating outliers are noise
+            m_spike_run = (m_spike_run != 0 && (z > 0.0f) == m_spike_up) ? m_spike_run + 1 : 1;
+            m_spike_up = z > 0.0f;
+            if (m_spike_run <= m_config.spike_run) {
+                return { Kind::SPIKE, z };
+            }
+            Result shift = accumulate(copysignf(m_config.z_threshold, z));
+            return shift.kind != Kind::NONE ? shift : Result{ Kind::SPIKE, z };
+        }
+        m_spike_run = 0;
+        learn(x);
+        return accumulate(z);
+    }
+
+    float getMean() const {
+        return m_mean;
+    }
+
+    void reset() {
+        m_count = 0;
+        m_mean = 0.0f;
+        m_m2 = 0.0f;
+        m_cusum_high = 0.0f;
+        m_cusum_low = 0.0f;
+        m_spike_run = 0;
+    }
+
+    static const char* kindName(Kind kind) {
+        switch (kind) {
+        case Kind::SPIKE:      return "SPIKE";
+        case Kind::SHIFT_UP:   return "SHIFT UP";
+        case Kind::SHIFT_DOWN: return "SHIFT DOWN";
+        default:               return "NONE";
+        }
+    }
+
+private:
+    /*
+    * @brief feed a standardized residual to the two sided CUSUM.
+    * @return SHIFT_* once either side crosses the decision level, the baseline then restarts
+    */
+    Result accumulate(float z) {
+        m_cusum_high = fmaxf(0.0f, m_cusum_high + z - m_config.cusum_drift);
+        m_cusum_low = fmaxf(0.0f, m_cusum_low - z - m_config.cusum_drift);
+        if (m_cusum_high > m_config.cusum_threshold) {
+            Result result = { Kind::SHIFT_UP, m_cusum_high };
+            reset(); // level changed, relearn the baseline around the new level
+            return result;
+        }
+        if (m_cusum_low > m_config.cusum_threshold) {
+            Result result = { Kind::SHIFT_DOWN, m_cusum_low };
+            reset();
+            return result;
+        }
+        return { Kind::NONE, z };
+    }
+
+    void learn(float x) {
+        m_count++;
+        float delta = x - m_mean;
+        m_mean += delta / static_cast<float>(m_count);
+        m_m2 += delta * (x - m_mean);
+    }
+
+    AnomalyConfig m_config;
+    uint32_t m_count = 0;
+    float m_mean = 0.0f;
+    float m_m2 = 0.0f; // sum of squared deviations from the running mean
+    float m_cusum_high = 0.0f;
+    float m_cusum_low = 0.0f;
+    uint32_t m_spike_run = 0; // consecutive spikes of the same sign
+    bool m_spike_up = false;  // sign of that run
+};
@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+* @brief: BlockPool is a lock-free pool of N fixed size blocks of T with per block reference counts.
+* Producers acquire a block and fill it in place, only the 16 bit handle travels through queues. Every consumer that
+* holds on to a block retains it and releases it when done, the last release returns the block to the pool.
+*
+* The free list is a Treiber stack of block indices. The head packs a 16 bit ABA tag above the index,
+* so a block that is popped and pushed back between another task's load and CAS can't corrupt the list.
+* No dynamic memory, safe to use from any task. Blocks are not cleared on acquire.
+*
+* For samples this small the atomics cost more than the copy they save (tools/bench_zero_copy.cpp times both paths),
+* the pool pays off in queue storage (2 bytes per slot), in fan-out without per subscriber copies and for larger T.
+*/
+template<typename T, size_t N>
+class BlockPool {
+public:
+    static_assert(N > 0 && N < 0xFFFF, "block index must fit in 16 bits with one value reserved");
+
+    using Handle = uint16_t;
+    static constexpr Handle INVALID_HANDLE = 0xFFFF;
+
+    struct Stats {
+        uint32_t capacity;
+        uint32_t in_use;
+        uint32_t high_water;
+        uint32_t exhausted; // acquire() calls that found the pool empty
+    };
+
+    /*
+    * @brief: Ownership policy for SampleBus, lets a bus carry handles and keep the reference counts right.
+    */
+    struct Ownership {
+        BlockPool* pool;
+        void retain(Handle handle) { pool->retain(handle); }
+        void release(Handle handle) { pool->release(handle); }
+    };
+
+    BlockPool() {
+        for (size_t i = 0; i < N; i++) {
+            m_next[i].store(static_cast<Handle>(i + 1 < N ? i + 1 : INVALID_HANDLE), std::memory_order_relaxed);
+            m_refs[i].store(0, std::memory_order_relaxed);
+        }
+        m_head.store(pack(0, 0), std::memory_order_relaxed);
+    }
+
+    /*
+    * @brief take a free block, the caller holds the only reference.
+    * @return handle, INVALID_HANDLE if the pool is exhausted
+    */
+    Handle acquire() {
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        while (1) {
+            Handle idx = index(head);
+            if (idx == INVALID_HANDLE) {
+                m_exhausted.fetch_add(1, std::memory_order_relaxed);
+                return INVALID_HANDLE;
+            }
+            Handle next = m_next[idx].load(std::memory_order_relaxed);
+            if (m_head.compare_exchange_weak(head, pack(next, tag(head) + 1), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                m_refs[idx].store(1, std::memory_order_relaxed);
+                uint32_t in_use = m_in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+                uint32_t high = m_high_water.load(std::memory_order_relaxed);
+                while (in_use > high && !m_high_water.compare_exchange_weak(high, in_use, std::memory_order_relaxed)) {
+                }
+                return idx;
+            }
+        }
+    }
+
+    void retain(Handle handle) {
+        m_refs[handle].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*
+    * @brief drop one reference, the block goes back to the pool when the last one is gone.
+    */
+    void release(Handle handle) {
+        // A sole owner can't race with a retain (that needs a reference), so skip the read-modify-write
+        if (m_refs[handle].load(std::memory_order_acquire) != 1 && m_refs[handle].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        m_in_use.fetch_sub(1, std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        do {
+            m_next[handle].store(index(head), std::memory_order_relaxed);
+        } while (!m_head.compare_exchange_weak(head, pack(handle, tag(head) + 1), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    T& get(Handle handle) {
+        return m_blocks[handle];
+    }
+
+    const T& get(Handle handle) const {
+        return m_blocks[handle];
+    }
+
+    Stats stats() const {
+        return {
+            static_cast<uint32_t>(N),
+            m_in_use.load(std::memory_order_relaxed),
+            m_high_water.load(std::memory_order_relaxed),
+            m_exhausted.load(std::memory_order_relaxed)
+        };
+    }
+
+private:
+    static uint32_t pack(Handle idx, uint32_t tag) {
+        return (tag << 16) | idx;
+    }
+
+    static Handle index(uint32_t head) {
+        return static_cast<Handle>(head & 0xFFFF);
+    }
+
+    static uint32_t tag(uint32_t head) {
+        return head >> 16;
+    }
+
+    std::array<T, N> m_blocks{};
+    std::array<std::atomic<Handle>, N> m_next;
+    std::array<std::atomic<uint16_t>, N> m_refs;
+    std::atomic<uint32_t> m_head;
+    std::atomic<uint32_t> m_in_use{ 0 };
+    std::atomic<uint32_t> m_high_water{ 0 };
+    std::atomic<uint32_t> m_exhausted{ 0 };
+};
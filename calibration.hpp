@@ -0,0 +1,247 @@
+#pragma once
+#include "fixed_point.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+/*
+* @brief: CalibrationTable maps a sensor's reading to its corrected value through a curve sampled on a uniform grid,
+* so applying a correction costs an index, a load and a multiply-add whatever the curve is.
+* Tables are built by constexpr functions: model curves known at build time are expanded by the compiler into
+* read-only data, per-unit coefficients loaded at startup go through the same builders once before polling starts.
+*   polynomial - c0 + c1 x + c2 x^2 ..., evaluated with Horner's scheme over [x_min, x_max]
+*   piecewise  - linear between (x, y) points sorted by x, the range is the first to the last point
+*   sampled    - any callable double(double), e.g. a Steinhart-Hart thermistor curve built at startup with std::log
+* Inputs outside the range are clamped to its ends, NaN and infinities pass through unchanged. Each entry stores the value and the slope to the next one,
+* applyBatch() is written without branches so the compiler can vectorize it (gathered loads on AVX2 and NEON).
+* The builders also store the table in Q16.16, applyFixed() corrects a fixed point reading with integer math only.
+*/
+template<size_t Size = 257>
+class CalibrationTable {
+public:
+    static_assert(Size >= 2, "a table needs at least one interval");
+
+    static constexpr size_t MAX_COEFFICIENTS = 8;
+    static constexpr size_t MAX_POINTS = 16;
+
+    struct Point {
+        float x;
+        float y;
+    };
+
+    template<typename Curve>
+    static constexpr CalibrationTable sampled(float x_min, float x_max, Curve curve) {
+        CalibrationTable table;
+        table.m_min = x_min;
+        table.m_max = x_max;
+        const double step = (static_cast<double>(x_max) - x_min) / (Size - 1);
+        table.m_inv_step = static_cast<float>(1.0 / step);
+        table.m_min_fixed = Q16_16::fromFloat(x_min).raw();
+        table.m_inv_step_fixed = static_cast<int64_t>(281474976710656.0 / (step * Q16_16::ONE) + 0.5); // 2^48 / step in raw units
+        double previous = curve(x_min);
+        for (size_t i = 0; i + 1 < Size; i++) {
+            double next = curve(x_min + (i + 1) * step);
+            table.m_value[i] = static_cast<float>(previous);
+            table.m_slope[i] = static_cast<float>(next - previous);
+            table.m_value_fixed[i] = Q16_16::fromFloat(static_cast<float>(previous)).raw();
+            table.m_slope_fixed[i] = Q16_16::fromFloat(static_cast<float>(next)).raw() - table.m_value_fixed[i];
+            previous = next;
+        }
+        table.m_max_fixed = Q16_16::fromFloat(x_max).raw();
+        return table;
+    }
+
+    static constexpr CalibrationTable identity(float x_min, float x_max) {
+        return polynomial(x_min, x_max, { 0.0f, 1.0f });
+    }
+
+    static constexpr CalibrationTable polynomial(float x_min, float x_max, const float* coefficients, size_t count) {
+        return sampled(x_min, x_max, [coefficients, count](double x) {
+            double y = 0.0;
+            for (size_t i = count; i > 0; i--) {
+                y = y * x + coefficients[i - 1];
+            }
+            return y;
+        });
+    }
+
+    static constexpr CalibrationTable polynomial(float x_min, float x_max, std::initializer_list<float> coefficients) {
+        return polynomial(x_min, x_max, coefficients.begin(), coefficients.size());
+    }
+
+    static constexpr CalibrationTable piecewise(const Point* points, size_t count) {
+        return sampled(points[0].x, points[count - 1].x, [points, count](double x) {
+            size_t i = 1;
+            while (i < count - 1 && x > points[i].x) {
+                i++;
+            }
+            const Point& a = points[i - 1];
+            const Point& b = points[i];
+            return a.y + (x - a.x) * (b.y - a.y) / (b.x - a.x);
+        });
+    }
+
+    static constexpr CalibrationTable piecewise(std::initializer_list<Point> points) {
+        return piecewise(points.begin(), points.size());
+    }
+
+    float apply(float x) const {
+        return lookup(x);
+    }
+
+    void applyBatch(const float* in, float* out, size_t n) const {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = lookup(in[i]);
+        }
+    }
+
+    /*
+    * @brief apply() for Q16.16 readings, integer math only. Clamps like apply(), outputs saturate at the Q16.16 range.
+    * Q16.16 has no NaN, Fixed::fromFloat() already turned a NaN reading into 0 before it gets here.
+    */
+    Q16_16 applyFixed(Q16_16 x) const {
+        int32_t raw = x.raw();
+        raw = raw < m_min_fixed ? m_min_fixed : raw;
+        raw = raw > m_max_fixed ? m_max_fixed : raw;
+        // (x - min) / step as a Q16 position, the product stays below (Size - 1) * 2^48
+        const int64_t position = (static_cast<int64_t>(raw - m_min_fixed) * m_inv_step_fixed) >> 32;
+        int64_t index = position >> 16;
+        index = index < static_cast<int64_t>(Size - 2) ? index : static_cast<int64_t>(Size - 2);
+        const int64_t fraction = position - (index << 16);
+        const int64_t value = m_value_fixed[index] + Q16_16::roundShift(fraction * m_slope_fixed[index], 16);
+        return Q16_16::fromRaw(Q16_16::saturate(value));
+    }
+
+    float minInput() const {
+        return m_min;
+    }
+
+    float maxInput() const {
+        return m_max;
+    }
+
+private:
+    static constexpr float LAST = static_cast<float>(Size - 1);
+
+    float lookup(float x) const {
+        float position = (x - m_min) * m_inv_step;
+        // written so NaN fails both compares and lands on 0, the cast below is only defined for finite values
+        position = position > 0.0f ? position : 0.0f;
+        position = position < LAST ? position : LAST;
+        int32_t index = static_cast<int32_t>(position);
+        index = index < static_cast<int32_t>(Size - 2) ? index : static_cast<int32_t>(Size - 2); // the last point interpolates its left interval at t = 1
+        const float y = m_value[index] + (position - static_cast<float>(index)) * m_slope[index];
+        return x - x == 0.0f ? y : x; // selects rather than branches, applyBatch() still vectorizes
+    }
+
+    float m_min = 0.0f;
+    float m_max = 1.0f;
+    float m_inv_step = 1.0f;
+    std::array<float, Size - 1> m_value{};
+    std::array<float, Size - 1> m_slope{};
+    int32_t m_min_fixed = 0;
+    int32_t m_max_fixed = Q16_16::ONE;
+    int64_t m_inv_step_fixed = int64_t(1) << 32; // identity range [0, 1]
+    std::array<int32_t, Size - 1> m_value_fixed{};
+    std::array<int32_t, Size - 1> m_slope_fixed{};
+};
+
+/*
+* @brief: One line of a calibration file, coefficients for one sensor unit:
+*   <sensor name> poly c0 c1 c2 ...     correction polynomial, over the range of the sensor's default table
+*   <sensor name> pwl x0 y0 x1 y1 ...   piecewise linear, at least two points sorted by x
+* Blank lines and lines starting with # are skipped by the caller.
+*/
+struct CalibrationSpec {
+    enum class Kind { POLYNOMIAL, PIECEWISE };
+
+    char name[24];
+    Kind kind;
+    float values[2 * CalibrationTable<>::MAX_POINTS];
+    size_t count; // coefficients, or points * 2
+
+    /*
+    * @return false if the line is malformed, has too many values or unsorted points
+    */
+    bool parse(const char* line) {
+        const char* p = line;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        size_t len = 0;
+        while (p[len] != '\0' && p[len] != ' ' && p[len] != '\t') {
+            len++;
+        }
+        if (len == 0 || len >= sizeof(name)) {
+            return false;
+        }
+        memcpy(name, p, len);
+        name[len] = '\0';
+        p += len;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        size_t max_values;
+        if (strncmp(p, "poly", 4) == 0) {
+            kind = Kind::POLYNOMIAL;
+            max_values = CalibrationTable<>::MAX_COEFFICIENTS;
+            p += 4;
+        }
+        else if (strncmp(p, "pwl", 3) == 0) {
+            kind = Kind::PIECEWISE;
+            max_values = 2 * CalibrationTable<>::MAX_POINTS;
+            p += 3;
+        }
+        else {
+            return false;
+        }
+        count = 0;
+        while (1) {
+            char* end;
+            float value = strtof(p, &end);
+            if (end == p) {
+                break;
+            }
+            if (count == max_values) {
+                return false;
+            }
+            values[count++] = value;
+            p = end;
+        }
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+            p++;
+        }
+        if (*p != '\0' || count == 0) {
+            return false;
+        }
+        if (kind == Kind::PIECEWISE) {
+            if (count < 4 || count % 2 != 0) {
+                return false;
+            }
+            for (size_t i = 2; i < count; i += 2) {
+                if (values[i] <= values[i - 2]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+    * @param range the default table, polynomials keep its input range
+    */
+    template<size_t Size>
+    CalibrationTable<Size> build(const CalibrationTable<Size>& range) const {
+        if (kind == Kind::POLYNOMIAL) {
+            return CalibrationTable<Size>::polynomial(range.minInput(), range.maxInput(), values, count);
+        }
+        typename CalibrationTable<Size>::Point points[CalibrationTable<Size>::MAX_POINTS] = {};
+        for (size_t i = 0; i < count / 2; i++) {
+            points[i] = { values[2 * i], values[2 * i + 1] };
+        }
+        return CalibrationTable<Size>::piecewise(points, count / 2);
+    }
+};
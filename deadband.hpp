@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+
+/*
+* @brief: DeadbandFilter implements send-on-delta at the sensor edge. A reading is only forwarded when it differs from the
+* last forwarded one by at least `delta`, so slow drift still gets through once it adds up, while noise inside the band
+* doesn't. A heartbeat forwards the reading anyway once `heartbeat` ticks passed without a send, so consumers can tell a
+* sensor that is unchanged (heartbeats keep coming) from one that is dead (nothing arrives).
+* Each forwarded reading carries how many were held back before it, all of them within the band of the previous send.
+* delta = 0 disables suppression. Only the producer task touches it, stats are read best effort.
+*/
+class DeadbandFilter {
+public:
+    struct Config {
+        float delta;
+        uint32_t heartbeat; // ticks
+    };
+
+    struct Decision {
+        bool send;
+        bool heartbeat;      // sent only because the heartbeat was due
+        uint32_t suppressed; // readings held back since the previous send
+    };
+
+    struct Stats {
+        uint32_t offered;
+        uint32_t sent;
+        uint32_t heartbeats;
+    };
+
+    void configure(const Config& config) {
+        m_config = config;
+    }
+
+    Decision offer(float value, uint32_t tick) {
+        m_stats.offered++;
+        bool moved = !m_started || m_config.delta <= 0.0f || value - m_last_sent >= m_config.delta || m_last_sent - value >= m_config.delta;
+        bool heartbeat = !moved && tick - m_last_tick >= m_config.heartbeat;
+        if (!moved && !heartbeat) {
+            m_suppressed++;
+            return { false, false, 0 };
+        }
+        Decision decision = { true, heartbeat, m_suppressed };
+        m_started = true;
+        m_last_sent = value;
+        m_last_tick = tick;
+        m_suppressed = 0;
+        m_stats.sent++;
+        if (heartbeat) {
+            m_stats.heartbeats++;
+        }
+        return decision;
+    }
+
+    const Config& config() const {
+        return m_config;
+    }
+
+    Stats stats() const {
+        return m_stats;
+    }
+
+private:
+    Config m_config = { 0.0f, 0 };
+    bool m_started = false;
+    float m_last_sent = 0.0f;
+    uint32_t m_last_tick = 0;
+    uint32_t m_suppressed = 0;
+    Stats m_stats = { 0, 0, 0 };
+};
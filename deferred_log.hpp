@@ -0,0 +1,279 @@
+#pragma once
+extern "C" {
+    #include "FreeRTOS.h"
+    #include "task.h"
+}
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+namespace log_detail {
+
+enum class ArgKind { SIGNED, UNSIGNED, SIGNED64, UNSIGNED64, FLOATING, CHAR, STRING, INVALID };
+
+template<typename T>
+consteval ArgKind argKind() {
+    if constexpr (std::is_same_v<T, char>) {
+        return ArgKind::CHAR;
+    }
+    else if constexpr (std::is_same_v<T, const char*>) {
+        return ArgKind::STRING;
+    }
+    else if constexpr (std::is_same_v<T, bool>) {
+        return ArgKind::UNSIGNED;
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+        return ArgKind::FLOATING;
+    }
+    else if constexpr (std::is_integral_v<T>) {
+        if constexpr (sizeof(T) > sizeof(int)) {
+            return std::is_signed_v<T> ? ArgKind::SIGNED64 : ArgKind::UNSIGNED64;
+        }
+        else {
+            return std::is_signed_v<T> ? ArgKind::SIGNED : ArgKind::UNSIGNED;
+        }
+    }
+    else {
+        return ArgKind::INVALID; // enums, pointers and structs must be converted by the caller
+    }
+}
+
+/*
+* @brief walk a printf format and check every conversion against the argument kinds, in order.
+* 64 bit integers need the ll length modifier, no other length modifiers are accepted.
+*/
+consteval bool formatMatches(const char* format, const ArgKind* kinds, size_t count) {
+    size_t arg = 0;
+    for (const char* p = format; *p != '\0'; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        p++;
+        if (*p == '%') {
+            continue;
+        }
+        while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '.' || (*p >= '0' && *p <= '9')) {
+            p++;
+        }
+        bool wide = false;
+        if (p[0] == 'l' && p[1] == 'l') {
+            wide = true;
+            p += 2;
+        }
+        if (arg >= count) {
+            return false;
+        }
+        ArgKind kind = kinds[arg++];
+        switch (*p) {
+        case 'd': case 'i':
+            if (kind != (wide ? ArgKind::SIGNED64 : ArgKind::SIGNED)) {
+                return false;
+            }
+            break;
+        case 'u': case 'x': case 'X': case 'o':
+            if (kind != (wide ? ArgKind::UNSIGNED64 : ArgKind::UNSIGNED)) {
+                return false;
+            }
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+            if (wide || kind != ArgKind::FLOATING) {
+                return false;
+            }
+            break;
+        case 'c':
+            if (wide || kind != ArgKind::CHAR) {
+                return false;
+            }
+            break;
+        case 's':
+            if (wide || kind != ArgKind::STRING) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+    return arg == count;
+}
+
+}
+
+/*
+* @brief: Type erased part of a log format, what the log task needs to turn a record back into text.
+*/
+struct LogFormatBase {
+    const char* format;
+    int (*render)(const char* format, const uint8_t* args, char* out, size_t len);
+};
+
+/*
+* @brief: A log format bound to its argument types. The format string is checked against Args at compile time,
+* a mismatch such as %d for a float does not build. Declare formats as static constexpr objects, the address of the
+* object is the ID a record carries, so no text is copied or formatted by the caller.
+* %s arguments are stored as pointers and must point at strings that outlive the record, string literals or typeName() results.
+*/
+template<typename... Args>
+class LogFormat : public LogFormatBase {
+public:
+    static constexpr size_t ARG_BYTES = (size_t(0) + ... + sizeof(Args));
+
+    consteval LogFormat(const char* text) : LogFormatBase{ text, &LogFormat::renderArgs } {
+        constexpr log_detail::ArgKind kinds[sizeof...(Args) + 1] = { log_detail::argKind<Args>()..., log_detail::ArgKind::INVALID };
+        if (!log_detail::formatMatches(text, kinds, sizeof...(Args))) {
+            throw "log format conversions don't match the argument types";
+        }
+    }
+
+    static void pack(uint8_t* out, Args... args) {
+        size_t offset = 0;
+        ((memcpy(out + offset, &args, sizeof(Args)), offset += sizeof(Args)), ...);
+    }
+
+private:
+    static int renderArgs(const char* format, const uint8_t* args, char* out, size_t len) {
+        std::tuple<Args...> values;
+        size_t offset = 0;
+        std::apply([&](auto&... value) { ((memcpy(&value, args + offset, sizeof(value)), offset += sizeof(value)), ...); }, values);
+        return std::apply([&](auto... value) { return snprintf(out, len, format, promote(value)...); }, values);
+    }
+
+    template<typename T>
+    static auto promote(T value) {
+        if constexpr (std::is_same_v<T, float>) {
+            return static_cast<double>(value);
+        }
+        else {
+            return value;
+        }
+    }
+};
+
+/*
+* @brief: DeferredLog moves formatting off the hot path. log() copies the format ID, the tick and the raw argument
+* bytes into a bounded lock-free MPSC ring (Vyukov's per-cell sequence scheme) and returns, it never blocks or
+* takes a kernel lock. Tasks call log(), interrupt handlers call logFromISR(), which differ only in how they read
+* the tick. If the ring is full the record is dropped and counted.
+* A single low priority task calls drain() to render records with snprintf and write them out.
+* A producer preempted between claiming a cell and publishing it only holds up the consumer, not other producers.
+*/
+template<size_t Capacity, size_t MaxArgBytes = 24>
+class DeferredLog {
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    struct Stats {
+        uint32_t logged;
+        uint32_t dropped;
+        uint32_t written;
+    };
+
+    DeferredLog() {
+        for (size_t i = 0; i < Capacity; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /*
+    * @return false if the ring was full and the record was dropped
+    */
+    template<typename... Args>
+    bool log(const LogFormat<Args...>& format, std::type_identity_t<Args>... args) {
+        return record(xTaskGetTickCount(), format, args...);
+    }
+
+    /*
+    * @brief log() for interrupt handlers, xTaskGetTickCount() must not be called from an ISR.
+    * @return false if the ring was full and the record was dropped
+    */
+    template<typename... Args>
+    bool logFromISR(const LogFormat<Args...>& format, std::type_identity_t<Args>... args) {
+        return record(xTaskGetTickCountFromISR(), format, args...);
+    }
+
+    /*
+    * @brief render up to max_records published records in order and hand each line to write(tick, line).
+    * Single consumer only.
+    * @return number of records written
+    */
+    template<typename Writer>
+    size_t drain(Writer&& write, size_t max_records = Capacity) {
+        char line[LINE_SIZE];
+        size_t written = 0;
+        while (written < max_records) {
+            Cell& cell = m_cells[m_dequeue & (Capacity - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != m_dequeue + 1) {
+                break; // empty, or the next record is still being filled
+            }
+            const Record record = cell.record;
+            cell.sequence.store(m_dequeue + Capacity, std::memory_order_release);
+            m_dequeue++;
+
+            record.format->render(record.format->format, record.args, line, sizeof(line));
+            write(record.tick, line);
+            written++;
+        }
+        m_written += static_cast<uint32_t>(written);
+        return written;
+    }
+
+    Stats stats() const {
+        return { m_logged.load(std::memory_order_relaxed), m_dropped.load(std::memory_order_relaxed), m_written };
+    }
+
+private:
+    template<typename... Args>
+    bool record(TickType_t tick, const LogFormat<Args...>& format, Args... args) {
+        static_assert(LogFormat<Args...>::ARG_BYTES <= MaxArgBytes, "log arguments don't fit in a record, raise MaxArgBytes");
+        size_t pos = m_enqueue.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (1) {
+            cell = &m_cells[pos & (Capacity - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else {
+                pos = m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+        cell->record.format = &format;
+        cell->record.tick = tick;
+        LogFormat<Args...>::pack(cell->record.args, args...);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        m_logged.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    static constexpr size_t LINE_SIZE = 128; // longer lines are truncated by snprintf
+
+    struct Record {
+        const LogFormatBase* format;
+        TickType_t tick;
+        uint8_t args[MaxArgBytes];
+    };
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    std::array<Cell, Capacity> m_cells;
+    std::atomic<size_t> m_enqueue{ 0 };
+    size_t m_dequeue = 0; // consumer only
+    std::atomic<uint32_t> m_logged{ 0 };
+    std::atomic<uint32_t> m_dropped{ 0 };
+    uint32_t m_written = 0;
+};
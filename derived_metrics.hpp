@@ -0,0 +1,204 @@
+#pragma once
+#include "sensor.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/*
+* @brief exp for building tables at compile time, std::exp isn't constexpr in C++20.
+* Reduces x to 2^k * exp(r) with |r| <= ln 2 / 2, then sums the Taylor series of exp(r).
+*/
+constexpr double constexprExp(double x) {
+    constexpr double LN2 = 0.6931471805599453;
+    int k = static_cast<int>(x / LN2 + (x >= 0.0 ? 0.5 : -0.5));
+    double r = x - k * LN2;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 20; n++) {
+        term *= r / n;
+        sum += term;
+    }
+    for (; k > 0; k--) {
+        sum *= 2.0;
+    }
+    for (; k < 0; k++) {
+        sum /= 2.0;
+    }
+    return sum;
+}
+
+/*
+* @brief: Saturation vapour pressure over water (Tetens: 0.6108 * exp(17.27 T / (T + 237.3)) kPa) from a table generated
+* at compile time, so a sample costs an index and a lerp instead of a libm exp. 0.5 C steps over -40..60 C keep the
+* interpolation error around 0.03 % (tools/bench_derived_metrics.cpp checks both directions against libm).
+* The table is monotonic, so it is also searched backwards to get the dew point.
+*/
+class SaturationVapourPressure {
+public:
+    static constexpr float T_MIN = -40.0f;
+    static constexpr float T_MAX = 60.0f;
+    static constexpr float STEP = 0.5f;
+    static constexpr size_t SIZE = static_cast<size_t>((T_MAX - T_MIN) / STEP) + 1;
+
+    /*
+    * @return kPa at `celsius`, clamped to the table range
+    */
+    static float at(float celsius) {
+        float position = (celsius - T_MIN) / STEP;
+        if (position <= 0.0f) {
+            return TABLE[0];
+        }
+        if (position >= SIZE - 1) {
+            return TABLE[SIZE - 1];
+        }
+        size_t i = static_cast<size_t>(position);
+        float t = position - static_cast<float>(i);
+        return TABLE[i] + t * (TABLE[i + 1] - TABLE[i]);
+    }
+
+    /*
+    * @brief temperature at which `kpa` is the saturation pressure, i.e. the dew point of air holding that vapour pressure.
+    */
+    static float dewPoint(float kpa) {
+        if (kpa <= TABLE[0]) {
+            return T_MIN;
+        }
+        if (kpa >= TABLE[SIZE - 1]) {
+            return T_MAX;
+        }
+        size_t low = 0;
+        size_t high = SIZE - 1;
+        while (high - low > 1) {
+            size_t mid = (low + high) / 2;
+            if (TABLE[mid] <= kpa) {
+                low = mid;
+            }
+            else {
+                high = mid;
+            }
+        }
+        float t = (kpa - TABLE[low]) / (TABLE[high] - TABLE[low]);
+        return T_MIN + (static_cast<float>(low) + t) * STEP;
+    }
+
+private:
+    static const std::array<float, SIZE> TABLE;
+};
+
+inline constexpr std::array<float, SaturationVapourPressure::SIZE> SaturationVapourPressure::TABLE = [] {
+    std::array<float, SIZE> table{};
+    for (size_t i = 0; i < SIZE; i++) {
+        double celsius = T_MIN + static_cast<double>(i) * STEP;
+        table[i] = static_cast<float>(0.6108 * constexprExp(17.27 * celsius / (celsius + 237.3)));
+    }
+    return table;
+}();
+
+/*
+* @brief: DerivedMetrics turns one plant's temperature, humidity and light streams into the numbers growers steer by:
+*   VPD       - vapour pressure deficit, es(T) * (1 - RH / 100) in kPa
+*   dew point - temperature at which the air's vapour pressure saturates
+*   DLI       - daily light integral in mol/m2/day, PPFD integrated over the current day
+* The streams arrive at different times, each update holds the other streams' latest value and VPD/dew point are only
+* reported while temperature and humidity are within align_ticks of each other. Light is integrated with the trapezoid
+* rule between consecutive readings, gaps longer than max_gap_ticks are treated as an outage and not integrated.
+* Days are counted from the first light reading in elapsed ticks, so the 32 bit tick wrapping doesn't move the day
+* boundary. A gap of two days or more leaves yesterday at zero rather than carrying over a stale day, gaps longer than
+* the tick range (49 days at 1 kHz) can't be told apart from short ones.
+* Constant time per update and no dynamic memory, keep one per sensor group.
+*/
+class DerivedMetrics {
+public:
+    struct Config {
+        uint32_t tick_hz;
+        uint32_t align_ticks;
+        uint32_t max_gap_ticks;
+        uint32_t day_ticks;
+        float lux_to_ppfd; // umol/m2/s per lux, depends on the light source
+    };
+
+    struct Values {
+        bool aligned;        // vpd and dew_point are valid
+        float vpd;           // kPa
+        float dew_point;     // C
+        float dli_today;     // mol/m2 so far today
+        float dli_yesterday; // mol/m2, whole previous day
+    };
+
+    void configure(const Config& config) {
+        m_config = config;
+    }
+
+    void update(Sensor::Type type, float value, uint32_t tick) {
+        switch (type) {
+        case Sensor::Type::TEMPERATURE:
+            m_temp = { value, tick, true };
+            updateMoisture();
+            break;
+        case Sensor::Type::HUMIDITY:
+            m_humidity = { value, tick, true };
+            updateMoisture();
+            break;
+        case Sensor::Type::LIGHT:
+            updateLight(value, tick);
+            break;
+        default:
+            break;
+        }
+    }
+
+    const Values& values() const {
+        return m_values;
+    }
+
+private:
+    struct Latest {
+        float value;
+        uint32_t tick;
+        bool valid;
+    };
+
+    void updateMoisture() {
+        if (!m_temp.valid || !m_humidity.valid) {
+            return;
+        }
+        // unsigned differences both ways, the smaller one is the distance even across a tick wrap
+        const uint32_t ahead = m_temp.tick - m_humidity.tick;
+        const uint32_t behind = m_humidity.tick - m_temp.tick;
+        uint32_t apart = ahead < behind ? ahead : behind;
+        m_values.aligned = apart <= m_config.align_ticks;
+        if (!m_values.aligned) {
+            return;
+        }
+        float rh = m_humidity.value < 0.0f ? 0.0f : m_humidity.value > 100.0f ? 100.0f : m_humidity.value;
+        float saturation = SaturationVapourPressure::at(m_temp.value);
+        float actual = saturation * rh / 100.0f;
+        m_values.vpd = saturation - actual;
+        m_values.dew_point = SaturationVapourPressure::dewPoint(actual);
+    }
+
+    void updateLight(float lux, uint32_t tick) {
+        const float ppfd = (lux > 0.0f ? lux : 0.0f) * m_config.lux_to_ppfd;
+        if (!m_light.valid) {
+            m_day_start = tick;
+        }
+        const uint32_t days = (tick - m_day_start) / m_config.day_ticks;
+        if (days > 0) {
+            m_values.dli_yesterday = days == 1 ? m_values.dli_today : 0.0f;
+            m_values.dli_today = 0.0f;
+            m_day_start += days * m_config.day_ticks;
+        }
+        if (m_light.valid && tick - m_light.tick <= m_config.max_gap_ticks) {
+            float seconds = static_cast<float>(tick - m_light.tick) / m_config.tick_hz;
+            m_values.dli_today += (m_light.value + ppfd) * 0.5f * seconds / 1e6f;
+        }
+        m_light = { ppfd, tick, true };
+    }
+
+    Config m_config = { 1000, 1000, 10000, 86400000, 0.0185f };
+    Latest m_temp = {};
+    Latest m_humidity = {};
+    Latest m_light = {}; // value holds PPFD
+    uint32_t m_day_start = 0; // tick the current day began at
+    Values m_values = {};
+};
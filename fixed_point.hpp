@@ -0,0 +1,159 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/*
+* @brief: Fixed is a signed Q-format number, FracBits of the Storage integer hold the fraction.
+* Meant for FPU-less targets where float math is soft-float. Products and conversions round to nearest,
+* intermediate results use a 64 bit type so they don't overflow before being scaled back.
+* Arithmetic saturates at the storage limits instead of wrapping, a reading pinned at full scale is easier to spot
+* (and to reason about) than one that flipped sign.
+*/
+template<int FracBits, typename Storage = int32_t>
+class Fixed {
+public:
+    static_assert(std::is_integral_v<Storage> && std::is_signed_v<Storage>, "Fixed needs a signed integer storage type");
+    static_assert(FracBits > 0 && FracBits < static_cast<int>(sizeof(Storage) * 8) - 1, "FracBits must leave room for sign and integer part");
+
+    using storage_type = Storage;
+    using wide_type = int64_t;
+    static constexpr int FRAC_BITS = FracBits;
+    static constexpr Storage ONE = static_cast<Storage>(Storage(1) << FracBits);
+
+    constexpr Fixed() : m_raw(0) {}
+
+    static constexpr Fixed fromRaw(Storage raw) {
+        Fixed f;
+        f.m_raw = raw;
+        return f;
+    }
+
+    static constexpr Fixed fromInt(int value) {
+        return fromRaw(saturate(static_cast<wide_type>(value) * ONE));
+    }
+
+    /*
+    * @brief convert rounding to nearest, values outside the representable range saturate and NaN becomes 0.
+    */
+    static constexpr Fixed fromFloat(float value) {
+        constexpr float MAX = static_cast<float>((std::numeric_limits<Storage>::max)());
+        constexpr float MIN = static_cast<float>((std::numeric_limits<Storage>::min)());
+        float scaled = value * static_cast<float>(ONE);
+        if (scaled != scaled) {
+            return Fixed();
+        }
+        scaled = scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f;
+        if (scaled >= MAX) {
+            return fromRaw((std::numeric_limits<Storage>::max)());
+        }
+        if (scaled <= MIN) {
+            return fromRaw((std::numeric_limits<Storage>::min)());
+        }
+        return fromRaw(static_cast<Storage>(scaled));
+    }
+
+    constexpr float toFloat() const {
+        return static_cast<float>(m_raw) / static_cast<float>(ONE);
+    }
+
+    constexpr Storage raw() const {
+        return m_raw;
+    }
+
+    constexpr Fixed operator+(Fixed other) const { return fromRaw(saturate(static_cast<wide_type>(m_raw) + other.m_raw)); }
+    constexpr Fixed operator-(Fixed other) const { return fromRaw(saturate(static_cast<wide_type>(m_raw) - other.m_raw)); }
+    constexpr Fixed& operator+=(Fixed other) { return *this = *this + other; }
+    constexpr Fixed& operator-=(Fixed other) { return *this = *this - other; }
+
+    constexpr Fixed operator*(Fixed other) const {
+        wide_type product = static_cast<wide_type>(m_raw) * other.m_raw;
+        return fromRaw(saturate(roundShift(product, FracBits)));
+    }
+
+    constexpr bool operator==(const Fixed&) const = default;
+    constexpr auto operator<=>(const Fixed&) const = default;
+
+    /*
+    * @brief divide by 2^shift rounding half away from zero, plain >> would round towards -infinity.
+    */
+    static constexpr wide_type roundShift(wide_type value, int shift) {
+        wide_type half = wide_type(1) << (shift - 1);
+        return value >= 0 ? (value + half) >> shift : -((-value + half) >> shift);
+    }
+
+    /*
+    * @brief clamp a wide intermediate result into the storage range.
+    */
+    static constexpr Storage saturate(wide_type value) {
+        constexpr wide_type MAX = (std::numeric_limits<Storage>::max)();
+        constexpr wide_type MIN = (std::numeric_limits<Storage>::min)();
+        return static_cast<Storage>(value > MAX ? MAX : (value < MIN ? MIN : value));
+    }
+
+private:
+    Storage m_raw;
+};
+
+using Q16_16 = Fixed<16>;
+
+/*
+* @brief: Integer sine for the fixed point sensor path. The angle is a phase in 1/2^32 turns, so stepping it by a
+* constant wraps for free, one turn is the full uint32_t range. A 256 interval table built at compile time plus
+* linear interpolation keeps the error below 1e-4 (about 6 Q16.16 steps), fine for the mock sensors' waveforms.
+*/
+class FixedSine {
+public:
+    static constexpr uint32_t phaseStep(double radians) {
+        return static_cast<uint32_t>(radians / (2.0 * PI) * 4294967296.0 + 0.5);
+    }
+
+    static Q16_16 sin(uint32_t phase) {
+        const uint32_t index = phase >> (32 - TABLE_BITS);
+        const int64_t fraction = (phase >> (32 - TABLE_BITS - 16)) & 0xFFFF; // Q16 position inside the interval
+        const int32_t a = TABLE[index];
+        const int32_t b = TABLE[index + 1];
+        return Q16_16::fromRaw(static_cast<int32_t>(a + Q16_16::roundShift(fraction * (b - a), 16)));
+    }
+
+private:
+    static constexpr int TABLE_BITS = 8;
+    static constexpr size_t TABLE_SIZE = (size_t(1) << TABLE_BITS) + 1;
+    static constexpr double PI = 3.14159265358979323846;
+
+    // Taylor series, only ever evaluated by the compiler. Arguments are folded into [-pi, pi] first.
+    static constexpr double taylorSin(double x) {
+        x = x > PI ? x - 2.0 * PI : x;
+        double term = x;
+        double sum = x;
+        for (int n = 1; n < 20; n++) {
+            term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+            sum += term;
+        }
+        return sum;
+    }
+
+    static constexpr std::array<int32_t, TABLE_SIZE> build() {
+        std::array<int32_t, TABLE_SIZE> table{};
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            const double value = taylorSin(2.0 * PI * static_cast<double>(i) / (TABLE_SIZE - 1)) * Q16_16::ONE;
+            table[i] = static_cast<int32_t>(value >= 0.0 ? value + 0.5 : value - 0.5);
+        }
+        return table;
+    }
+
+    static const std::array<int32_t, TABLE_SIZE> TABLE;
+};
+
+inline constexpr std::array<int32_t, FixedSine::TABLE_SIZE> FixedSine::TABLE = FixedSine::build();
+
+template<typename T>
+struct is_fixed_point : std::false_type {};
+
+template<int FracBits, typename Storage>
+struct is_fixed_point<Fixed<FracBits, Storage>> : std::true_type {};
+
+template<typename T>
+concept FixedPoint = is_fixed_point<T>::value;
@@ -0,0 +1,138 @@
+#pragma once
+#include <cstddef>
+#if defined(_WIN32)
+// WIN32_LEAN_AND_MEAN is a project wide define, so the port's windows.h leaves winsock.h out and winsock2.h can follow it
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/*
+* @brief: The few socket calls the host side modules (TelemetrySink, SnapshotServer) make, over BSD sockets or winsock2.
+* Only names and signatures differ between the two, error handling stays with the caller. Winsock needs WSAStartup()
+* before the first socket call, startup() does that once per process and is a no-op elsewhere. The simulator never
+* calls WSACleanup(), the sockets live until the process exits.
+*/
+namespace host_socket {
+
+#if defined(_WIN32)
+using Handle = SOCKET;
+using PollFd = WSAPOLLFD;
+inline constexpr Handle INVALID = INVALID_SOCKET;
+#else
+using Handle = int;
+using PollFd = pollfd;
+inline constexpr Handle INVALID = -1;
+#endif
+
+/*
+* @return false if winsock couldn't be initialised, no socket call will work then
+*/
+inline bool startup() {
+#if defined(_WIN32)
+    static const bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return started;
+#else
+    return true;
+#endif
+}
+
+inline void close(Handle socket) {
+#if defined(_WIN32)
+    closesocket(socket);
+#else
+    ::close(socket);
+#endif
+}
+
+inline bool setNonBlocking(Handle socket) {
+#if defined(_WIN32)
+    u_long on = 1;
+    return ioctlsocket(socket, FIONBIO, &on) == 0;
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+/*
+* @brief let a restarted server bind its port while old connections are in TIME_WAIT. Winsock allows that already,
+* its SO_REUSEADDR would let another process take over a bound port instead, so it isn't set there.
+*/
+inline void reuseAddress(Handle socket) {
+#if defined(_WIN32)
+    (void)socket;
+#else
+    int one = 1;
+    setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#endif
+}
+
+/*
+* @return true if the last failed call on this thread would have blocked on a non-blocking socket
+*/
+inline bool wouldBlock() {
+#if defined(_WIN32)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+/*
+* @return true if the last failed call on this thread was interrupted by a signal and can be retried
+*/
+inline bool interrupted() {
+#if defined(_WIN32)
+    return WSAGetLastError() == WSAEINTR;
+#else
+    return errno == EINTR;
+#endif
+}
+
+/*
+* @brief poll() or WSAPoll(), same events and revents.
+* @return descriptors with events, 0 on timeout, negative on error
+*/
+inline int poll(PollFd* fds, size_t count, int timeout_ms) {
+#if defined(_WIN32)
+    return WSAPoll(fds, static_cast<ULONG>(count), timeout_ms);
+#else
+    return ::poll(fds, static_cast<nfds_t>(count), timeout_ms);
+#endif
+}
+
+/*
+* @return bytes received, 0 once the peer closed, negative on error
+*/
+inline long receive(Handle socket, void* buffer, size_t len) {
+#if defined(_WIN32)
+    return ::recv(socket, static_cast<char*>(buffer), static_cast<int>(len), 0);
+#else
+    return static_cast<long>(::recv(socket, buffer, len, 0));
+#endif
+}
+
+/*
+* @brief send() that doesn't raise SIGPIPE when the peer is gone, winsock never does.
+* @return bytes sent, negative on error
+*/
+inline long send(Handle socket, const void* data, size_t len) {
+#if defined(_WIN32)
+    return ::send(socket, static_cast<const char*>(data), static_cast<int>(len), 0);
+#else
+    return static_cast<long>(::send(socket, data, len, MSG_NOSIGNAL));
+#endif
+}
+
+}
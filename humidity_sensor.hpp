@@ -6,7 +6,7 @@
 /*
 * @brief: The HumiditySensor class is a mock sensor that provides mock data within realistic bounds.
 */
-class HumiditySensor : public Sensor {
+class HumiditySensor final : public Sensor {
 public:
     HumiditySensor() : Sensor(Type::HUMIDITY) {}
 
@@ -20,4 +20,15 @@ public:
             m_counter++
         };
     }
+
+    FixedData readFixed() const override {
+        static constexpr Q16_16 BASE = Q16_16::fromFloat(30.0f - 0.01f); // folded by the compiler, no float at runtime
+        static constexpr Q16_16 SPIKE = Q16_16::fromFloat(0.5f);
+        Q16_16 humidity = m_counter % 200 == 0 ? BASE + SPIKE : BASE;
+        return {
+            humidity < Q16_16::fromInt(100) ? humidity : Q16_16::fromInt(100),
+            Type::HUMIDITY,
+            m_counter++
+        };
+    }
 };
\ No newline at end of file
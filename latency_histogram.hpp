@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/*
+* @brief: Fixed size histogram for tick based durations. Bucket i counts values of exactly i ticks,
+* the last bucket collects everything at or above Buckets - 1. No dynamic memory, safe to keep inside tasks.
+*/
+template<size_t Buckets>
+class LatencyHistogram {
+public:
+    static_assert(Buckets >= 2, "need at least one bucket plus the overflow bucket");
+
+    void record(uint32_t value) {
+        size_t bucket = value < Buckets - 1 ? value : Buckets - 1;
+        m_buckets[bucket]++;
+        m_count++;
+        if (value > m_max) {
+            m_max = value;
+        }
+    }
+
+    /*
+    * @brief smallest value v such that at least p percent of samples are <= v.
+    * @return the value, Buckets - 1 if the percentile falls in the overflow bucket (see getMax() for the real worst case)
+    */
+    uint32_t percentile(float p) const {
+        if (m_count == 0) {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(p / 100.0f * m_count + 0.5f);
+        if (target == 0) {
+            target = 1;
+        }
+        uint64_t seen = 0;
+        for (size_t i = 0; i < Buckets; i++) {
+            seen += m_buckets[i];
+            if (seen >= target) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+        return static_cast<uint32_t>(Buckets - 1);
+    }
+
+    uint32_t getCount() const {
+        return m_count;
+    }
+
+    uint32_t getMax() const {
+        return m_max;
+    }
+
+    /*
+    * @brief fold another histogram into this one, e.g. to combine per shard histograms for display.
+    */
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < Buckets; i++) {
+            m_buckets[i] += other.m_buckets[i];
+        }
+        m_count += other.m_count;
+        if (other.m_max > m_max) {
+            m_max = other.m_max;
+        }
+    }
+
+    void reset() {
+        m_buckets.fill(0);
+        m_count = 0;
+        m_max = 0;
+    }
+
+private:
+    std::array<uint32_t, Buckets> m_buckets{};
+    uint32_t m_count = 0;
+    uint32_t m_max = 0;
+};
@@ -6,7 +6,7 @@
 /*
 * @brief: The LightSensor class is a mock sensor that provides mock data within realistic bounds.
 */
-class LightSensor : public Sensor {
+class LightSensor final : public Sensor {
 public:
     LightSensor() : Sensor(Type::LIGHT) {}
     
@@ -19,4 +19,18 @@ public:
             m_counter++
         };
     }
+
+    FixedData readFixed() const override {
+        static constexpr uint32_t SLOW_STEP = FixedSine::phaseStep(0.005);
+        static constexpr uint32_t FAST_STEP = FixedSine::phaseStep(0.1);
+        Q16_16 baseline = Q16_16::fromInt(500) + Q16_16::fromInt(300) * FixedSine::sin(m_counter * SLOW_STEP);
+        Q16_16 swing = Q16_16::fromInt(150) * FixedSine::sin(m_counter * FAST_STEP);
+        Q16_16 noise = Q16_16::fromRaw(static_cast<int32_t>(static_cast<int64_t>(swing.raw()) * (rand() % 100) / 100));
+        Q16_16 light = baseline + noise;
+        return {
+            light.raw() < 0 ? Q16_16() : light,
+            Type::LIGHT,
+            m_counter++
+        };
+    }
 };
\ No newline at end of file
@@ -9,171 +9,1193 @@ extern "C" {
 #include "temp_sensor.hpp"
 #include "light_sensor.hpp"
 #include "humidity_sensor.hpp"
+#include "sensor_set.hpp"
 #include "moving_average.hpp"
+#include "fixed_point.hpp"
+#include "processed_sample.hpp"
+#include "sample_bus.hpp"
+#include "raw_channel.hpp"
+#include "latency_histogram.hpp"
+#include "shard_router.hpp"
+#include "block_pool.hpp"
+#include "anomaly_detector.hpp"
+#include "quantile_digest.hpp"
+#include "telemetry_format.hpp"
+#include "telemetry_sink.hpp"
+#include "trace_events.hpp"
+#include "deferred_log.hpp"
+#include "wakeup_accounting.hpp"
+#include "period_monitor.hpp"
+#include "derived_metrics.hpp"
+#include "deadband.hpp"
+#include "sensor_bus.hpp"
+#include "calibration.hpp"
+#include "pipeline_graph.hpp"
+#include "snapshot_server.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cmath>
+#include <thread>
+#include <type_traits>
 
-static QueueHandle_t xRawDataQueue;
-static QueueHandle_t xProcessedDataQueue;
+// Raw path from sensor to processor, the backpressure policy decides what happens when the processor falls behind
+static const UBaseType_t RAW_QUEUE_DEPTH = 5;
+static const RawChannel::Policy RAW_BACKPRESSURE_POLICY = RawChannel::Policy::COALESCE;
 
-// Non-Blocking Prints FIXME: remove and use regular printfs
-static const uint8_t PRINT_QUEUE_LEN = 10;
-static const uint16_t PRINT_BUF_SIZE = 128; // Max line length
-static QueueHandle_t xPrintQueue;
+// Sharded processing: sensors are hash partitioned over PROCESSOR_SHARDS processor tasks, each with its own raw channel.
+// A sensor's filter state is only touched by the shard that owns it. With work stealing on, ownership of a sensor
+// migrates from the busiest to the idlest shard once per SHARD_REBALANCE_PERIOD. The Win32 port runs one task at a time,
+// so more shards only pay off on SMP kernels, tools/bench_shards.cpp shows what they buy on a multi-core host.
+static const size_t MAX_PROCESSOR_SHARDS = 4;
+static const size_t PROCESSOR_SHARDS = 1;
+static const bool PROCESSOR_WORK_STEALING = false;
+static const TickType_t SHARD_REBALANCE_PERIOD = pdMS_TO_TICKS(1000);
+static RawSamplePool raw_pool; // raw samples are filled in place, only handles travel through the lanes
+static RawChannel raw_channels[MAX_PROCESSOR_SHARDS];
+static ShardRouter<MAX_PROCESSOR_SHARDS, Sensor::TYPE_COUNT> shard_router;
 
-//struct PrintCommand {
-//    char buffer[PRINT_BUF_SIZE];
-//    bool is_control_seq; // Not used for windows, but used to denote ANSI control codes
-//};
+// Anomaly stage, detector state is per sensor and owned by the same shard as the filter
+static const AnomalyConfig ANOMALY_CONFIG[Sensor::TYPE_COUNT] = {
+    // z     k     h     min sd  warmup run
+    { 4.0f, 0.5f, 8.0f, 0.05f,  50,    3 },  // TEMPERATURE
+    { 5.0f, 0.5f, 10.0f, 5.0f,  50,    3 },  // LIGHT
+    { 3.0f, 0.5f, 8.0f, 0.05f,  20,    3 },  // HUMIDITY, watering shows up as a +0.5 % RH spike
+};
+static AnomalyDetector anomaly_detectors[Sensor::TYPE_COUNT];
+static const UBaseType_t ALERT_QUEUE_DEPTH = 8;
+static QueueHandle_t xAlertQueue;
+static std::atomic<uint32_t> alerts_dropped{ 0 }; // alert queue full, written by every processor shard
+
+// Last hour distribution per sensor: six 10 minute t-digest slices, constant memory whatever the sample rate
+using HourlyQuantiles = WindowedDigest<6, 50>;
+static const TickType_t QUANTILE_SLICE_TICKS = pdMS_TO_TICKS(10 * 60 * 1000);
+static const TickType_t QUANTILE_REFRESH_PERIOD = pdMS_TO_TICKS(1000); // summarizing merges all slices, don't do it per sample
+static HourlyQuantiles sensor_quantiles[Sensor::TYPE_COUNT]; // owned by the sensor's shard like the filters
+static TickType_t quantiles_refreshed[Sensor::TYPE_COUNT];
+
+// Send-on-delta at the sensor edge, readings within delta of the last sent one stay off the raw path.
+// The heartbeat sends anyway after that long, a sensor quiet for 1.5 heartbeats is flagged stale on the dashboard.
+static const DeadbandFilter::Config EDGE_DEADBAND[Sensor::TYPE_COUNT] = {
+    // delta  heartbeat
+    { 0.5f,  pdMS_TO_TICKS(5000) },  // TEMPERATURE, C, the mock sensor's noise is +-0.5
+    { 0.0f,  pdMS_TO_TICKS(5000) },  // LIGHT, off, DLI integrates every reading
+    { 0.1f,  pdMS_TO_TICKS(5000) },  // HUMIDITY, % RH, watering spikes are +0.5
+};
+static DeadbandFilter edge_filters[Sensor::TYPE_COUNT]; // only touched by vSensorTask
+
+// One day in ticks, in 64 bit: pdMS_TO_TICKS multiplies in TickType_t, which overflows for a day's worth of ms
+static constexpr uint64_t DAY_TICKS = 24ULL * 60 * 60 * configTICK_RATE_HZ;
+static_assert(DAY_TICKS <= static_cast<TickType_t>(-1), "a day of ticks must fit in TickType_t");
+
+// Derived agronomic metrics (VPD, dew point, DLI) over the filtered streams. Temperature and humidity readings more than
+// DERIVED_ALIGN_WINDOW apart aren't combined. The shards update it under the dashboard mutex, which already serialises them.
+// The edge deadband only sends a steady reading again at its heartbeat, until then the last sent value still holds,
+// so the window spans the longer heartbeat plus slack for the heartbeat only being checked when the sensor is polled.
+static const TickType_t TEMP_HEARTBEAT = EDGE_DEADBAND[static_cast<size_t>(Sensor::Type::TEMPERATURE)].heartbeat;
+static const TickType_t HUMIDITY_HEARTBEAT = EDGE_DEADBAND[static_cast<size_t>(Sensor::Type::HUMIDITY)].heartbeat;
+static const TickType_t DERIVED_ALIGN_WINDOW = (TEMP_HEARTBEAT > HUMIDITY_HEARTBEAT ? TEMP_HEARTBEAT : HUMIDITY_HEARTBEAT) + pdMS_TO_TICKS(1000);
+static const DerivedMetrics::Config DERIVED_CONFIG = {
+    configTICK_RATE_HZ,
+    DERIVED_ALIGN_WINDOW,
+    pdMS_TO_TICKS(10000),         // light gaps longer than this are an outage, not integrated
+    static_cast<TickType_t>(DAY_TICKS),
+    0.0185f                       // lux to PPFD for sunlight, about 0.014 for white LEDs
+};
+static DerivedMetrics plant_metrics;
+
+// Fixed point filter path: built-in sensors are read with readFixed(), calibrated with applyFixed() and filtered in
+// Q16.16 without any float math, the running sum stays exact instead of drifting like a float sum does. The reading
+// also travels as float for the stages that only exist in float (deadband, lanes, digests, anomaly detector) and the
+// filtered value is converted once for display. Runtime sensors without their own readFixed() convert their reading.
+// Q16.16 saturates at +-32767, enough for the mock sensors but not for lux in direct sunlight.
+static const bool PROCESSOR_FIXED_POINT = true;
+static const size_t FILTER_WINDOW = 5;
+using SensorFilter = std::conditional_t<PROCESSOR_FIXED_POINT, MovingAverage<Q16_16, FILTER_WINDOW>, MovingAverage<float, FILTER_WINDOW>>;
+static SensorFilter sensor_filters[Sensor::TYPE_COUNT]; // indexed by sensor ID, owned by whichever shard the router says
+static float held_values[Sensor::TYPE_COUNT]; // last value received per sensor, stands in for readings the edge held back
+static Q16_16 held_fixed[Sensor::TYPE_COUNT]; // the same in Q16.16 for the fixed point filter
+
+// Calibration at the sensor edge, before the deadband so it compares corrected values. The defaults are the sensor
+// models' curves, expanded into tables at compile time. Per-unit curves in CALIBRATION_PATH replace them at startup,
+// one line per sensor, see CalibrationSpec for the format.
+using SensorCalibration = CalibrationTable<>;
+static constexpr SensorCalibration DEFAULT_CALIBRATION[Sensor::TYPE_COUNT] = {
+    SensorCalibration::polynomial(-40.0f, 85.0f, { -0.12f, 1.004f, -0.00011f }),                           // TEMPERATURE, probe linearity
+    SensorCalibration::piecewise({ { 0.0f, 0.0f }, { 1000.0f, 1000.0f }, { 5000.0f, 5150.0f }, { 20000.0f, 21800.0f } }), // LIGHT, photodiode compression
+    SensorCalibration::identity(0.0f, 100.0f),                                                              // HUMIDITY
+};
+static const char* const CALIBRATION_PATH = "plant-monitor-calibration.txt";
+static SensorCalibration sensor_calibration[Sensor::TYPE_COUNT]; // filled by loadCalibration before the scheduler starts
+
+// Priority lanes on the raw path, lane 0 is the most urgent. Drained by weight so bulk data still makes progress.
+enum RawLane : size_t { LANE_URGENT = 0, LANE_NORMAL = 1, LANE_BULK = 2, RAW_LANE_COUNT = 3 };
+static const RawChannel::Drain RAW_DRAIN_POLICY = RawChannel::Drain::WEIGHTED;
+static const uint8_t RAW_LANE_WEIGHTS[RAW_LANE_COUNT] = { 4, 2, 1 };
+static const float HUMIDITY_URGENT_DELTA = 0.3f; // % RH jump between readings that counts as urgent (watering, leaks)
+static const uint32_t LIGHT_FLOOD_BURST = 0; // extra bulk light samples per poll, set > 0 to measure urgent lane latency under load
+static LatencyHistogram<64> raw_lane_latency[MAX_PROCESSOR_SHARDS][RAW_LANE_COUNT]; // ticks from send to processor pickup, per shard and lane
+
+static_assert(MAX_PROCESSOR_SHARDS * RawChannel::MAX_LANES * (RAW_QUEUE_DEPTH + Sensor::TYPE_COUNT) + MAX_PROCESSOR_SHARDS + 1 <= RAW_POOL_BLOCKS,
+    "raw pool too small to cover every lane slot, coalescing aggregate and in flight sample");
+
+// Fan-out of processed samples, each consumer subscribes with its own buffer in buildPipeline: the logger always, the
+// telemetry exporter when TELEMETRY_SINK is set. Alerting doesn't need every sample, the anomaly stage feeds it through
+// xAlertQueue so an alert never waits behind bus backlog. Samples are published once into a reference counted pool block, subscribers share the block instead of a copy each.
+static const size_t MAX_BUS_SUBSCRIBERS = 4;
+static const size_t PROCESSED_POOL_BLOCKS = 64;
+using ProcessedPool = BlockPool<ProcessedSample, PROCESSED_POOL_BLOCKS>;
+using ProcessedBus = SampleBus<ProcessedPool::Handle, MAX_BUS_SUBSCRIBERS, ProcessedPool::Ownership>;
+static ProcessedPool processed_pool;
+static ProcessedBus processed_bus(ProcessedPool::Ownership{ &processed_pool });
+
+// Binary telemetry export, wire format in telemetry_format.hpp, tools/telemetry_decode.cpp reads it back.
+// The exporter is a processed bus subscriber, so a slow collector only ever costs its own buffer.
+static const TelemetrySink::Kind TELEMETRY_SINK = TelemetrySink::Kind::NONE;
+static const char* const TELEMETRY_PATH = "/tmp/plant-monitor.telemetry"; // FIFO/file path, Unix socket path or "ip:port" for UDP
+static const UBaseType_t TELEMETRY_BUFFER_DEPTH = 32;
+static const TickType_t TELEMETRY_FLUSH_PERIOD = pdMS_TO_TICKS(500); // max time a record waits for its batch to fill
+static const bool TELEMETRY_COMPARE_TEXT = true; // also count what the same records would cost as CSV text
+
+struct TelemetryStats {
+    uint32_t records;
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t text_bytes;
+    uint32_t write_errors;
+};
+static TelemetryStats telemetry_stats;
+static ProcessedBus::Handle telemetry_subscription = ProcessedBus::INVALID_HANDLE;
+
+// Local HTTP endpoint, JSON under /api and Prometheus text under /metrics. The dashboard task renders
+// every document once per update, requests are served from that rendering by the server's own thread.
+enum HttpDocument { HTTP_CURRENT, HTTP_HISTORY, HTTP_STATS, HTTP_METRICS, HTTP_DOCUMENT_COUNT };
+using HttpServer = SnapshotServer<HTTP_DOCUMENT_COUNT>;
+static const uint16_t HTTP_PORT = 8080; // 127.0.0.1 only, 0 disables
+static const HttpServer::Route HTTP_ROUTES[HTTP_DOCUMENT_COUNT] = {
+    { "/api/current", "application/json" },
+    { "/api/history", "application/json" },
+    { "/api/stats", "application/json" },
+    { "/metrics", "text/plain; version=0.0.4" },
+};
+static const size_t HTTP_HISTORY_LENGTH = 120;
+static const TickType_t HTTP_HISTORY_INTERVAL = pdMS_TO_TICKS(5000); // 10 minutes of history
+static const char* const HTTP_SENSOR_KEYS[Sensor::TYPE_COUNT] = { "temperature", "light", "humidity" }; // JSON keys and metric labels
+static HttpServer http_server;
+
+// Trace recorder snapshots (PLANT_MONITOR_TRACE=1 builds only), the ring buffer is rewritten to the same file every period
+// so the file always holds the most recent window. tools/trace_to_chrome.cpp converts it for chrome://tracing or Perfetto.
+static const char* const TRACE_SNAPSHOT_PATH = "plant-monitor-trace.bin";
+static const TickType_t TRACE_DUMP_PERIOD = pdMS_TO_TICKS(10000);
+
+// Deferred logging: callers enqueue a format ID plus raw arguments, vLogTask formats and writes them.
+// The dashboard redraws the console, so the log goes to a file unless LOG_PATH is NULL.
+static const char* const LOG_PATH = "plant-monitor.log";
+static const TickType_t LOG_FLUSH_PERIOD = pdMS_TO_TICKS(250);
+using PipelineLog = DeferredLog<64>;
+static PipelineLog pipeline_log;
+static const UBaseType_t LOG_BUFFER_DEPTH = 16; // processed samples buffered for the log between flushes
+static const TickType_t LOG_SAMPLE_PERIOD = pdMS_TO_TICKS(5000); // one line of latest filtered values per period
+static ProcessedBus::Handle log_subscription = ProcessedBus::INVALID_HANDLE;
+
+static constexpr LogFormat<unsigned, unsigned> LOG_STARTED("pipeline started: %u shards, %u sensors");
+static constexpr LogFormat<float, float, float, unsigned> LOG_PROCESSED("temperature %.2f light %.2f humidity %.2f (%u samples)");
+static constexpr LogFormat<const char*, const char*, float, float> LOG_ANOMALY("%s %s value %.2f score %.1f");
+static constexpr LogFormat<const char*> LOG_ALERT_DROPPED("alert queue full, %s alert dropped");
+static constexpr LogFormat<uint32_t> LOG_SHARD_MIGRATION("sensor moved to another shard, %u migrations so far");
+static constexpr LogFormat<unsigned> LOG_TELEMETRY_WRITE_FAILED("telemetry frame %u not written");
+static constexpr LogFormat<const char*, unsigned> LOG_CALIBRATION_LOADED("calibration for %s loaded from line %u");
+static constexpr LogFormat<unsigned> LOG_CALIBRATION_REJECTED("calibration line %u not understood, ignored");
+static constexpr LogFormat<unsigned> LOG_HTTP_STARTED("http endpoint listening on 127.0.0.1:%u");
+static constexpr LogFormat<unsigned> LOG_HTTP_FAILED("http endpoint on port %u not started");
+
+// Wakeup accounting for checking that tickless idle pays off, rates are averaged over WAKEUP_REPORT_WINDOW.
+// Times are in run time counter units (ulGetRunTimeCounterValue).
+static const uint32_t RUN_TIME_COUNTER_HZ = 100000;
+static const uint64_t WAKEUP_REPORT_WINDOW = RUN_TIME_COUNTER_HZ; // 1 s
+static WakeupAccounting<> wakeup_accounting(RUN_TIME_COUNTER_HZ);
+
+// Soak runs in virtual time, build with PLANT_MONITOR_VIRTUAL_TIME=1. Idle periods are skipped rather than slept, the run
+// stops after SOAK_DURATION of simulated time and prints end of run statistics. The mock sensors draw from rand(),
+// seeded with SIMULATION_SEED, so every run sees the same readings. Every clock the pipeline reads (the run time
+// counter, and through it the sensor bus) follows the tick, only the report's real time factor looks at the host clock.
+static const unsigned SIMULATION_SEED = 1;
+static constexpr uint64_t SOAK_TICKS = 7 * DAY_TICKS;
+static_assert(SOAK_TICKS <= static_cast<TickType_t>(-1), "the soak duration must fit in TickType_t");
+static const TickType_t SOAK_DURATION = static_cast<TickType_t>(SOAK_TICKS);
+static const TickType_t SOAK_REDRAW_INTERVAL = static_cast<TickType_t>(60ULL * 60 * configTICK_RATE_HZ); // simulated time outruns the console by far
+static std::atomic<size_t> kernel_heap_allocated{ 0 }; // bytes handed out by pvPortMalloc since start, heap_3 doesn't track it
+static std::atomic<size_t> kernel_heap_blocks{ 0 };    // blocks allocated since start
+static std::atomic<size_t> kernel_heap_freed{ 0 };     // blocks freed since start, heap_3 reports no size for them
+
+// Periodic tasks run on an absolute schedule (xTaskDelayUntil) and are monitored for lateness, activation jitter,
+// deadline misses and overruns. The sensor deadline is the time allowed from release until every reading is sent.
+static const TickType_t SENSOR_POLL_PERIOD = pdMS_TO_TICKS(100);
+static const TickType_t SENSOR_POLL_DEADLINE = pdMS_TO_TICKS(20);
+static const uint32_t JITTER_BUCKET_US = 100; // jitter histogram resolution
+static PeriodMonitor<> sensor_period;
+static PeriodMonitor<> log_period;
+
+// Pipeline topology, declared once in buildPipeline(). A stage that is cheap enough runs inside its upstream stage's
+// task instead of behind a queue, see PipelineGraph. The chosen layout and per edge throughput are on the dashboard.
+enum PipelineStage : size_t { STAGE_SENSOR, STAGE_PROCESSOR, STAGE_ALERT, STAGE_DASHBOARD, STAGE_TELEMETRY, STAGE_LOG, STAGE_TRACE_DUMP, STAGE_SOAK, STAGE_COUNT };
+enum PipelineEdge : size_t { EDGE_RAW, EDGE_ALERTS, EDGE_DASHBOARD, EDGE_TELEMETRY, EDGE_LOG, EDGE_COUNT };
+static const float PIPELINE_FUSE_BUDGET = 0.05f; // estimated share of a CPU a task may reach by fusing stages into it
+static const uint32_t SENSOR_STAGE_COST_US = 30; // rough per activation / per sample costs on the simulator
+static const uint32_t PROCESSOR_STAGE_COST_US = 60;
+static PipelineGraph<STAGE_COUNT, EDGE_COUNT> pipeline;
+
+// Sensors, Queues and dashboard data instances all global for simplicity
+// The built-in suite is polled through static dispatch, sensors added at runtime go through the virtual interface
+using BuiltinSensors = SensorSet<TempSensor, LightSensor, HumiditySensor>;
+static BuiltinSensors sensor_set;
+static const size_t MAX_RUNTIME_SENSORS = 8;
+static Sensor* runtime_sensors[MAX_RUNTIME_SENSORS];
+static size_t runtime_sensor_count = 0;
+
+// How the sensor task talks to the sensors. DIRECT (default) reads one mock sensor per release with no I/O cost, the opt-in bus modes
+// read every sensor each release through a simulated shared bus with real conversion times, see sensor_bus.hpp.
+// Bus devices are the built-in sensors, then the runtime ones, then SENSOR_BUS_LOAD_DEVICES devices that only occupy
+// the bus, set it to 97 to measure a 100 device bus. The cycle time is on the dashboard.
+enum class SensorIo { DIRECT, BUS_BLOCKING, BUS_OVERLAPPED };
+static const SensorIo SENSOR_IO = SensorIo::DIRECT;
+static const SensorBus<>::Timing SENSOR_BUS_TIMING = { 25, 23, 8 }; // 400 kHz I2C, up to 8 devices per transaction
+static const uint32_t BUILTIN_CONVERSION_US[BuiltinSensors::SIZE] = { 10000, 16000, 15000 }; // same order as BuiltinSensors
+static const uint8_t BUILTIN_READ_BYTES[BuiltinSensors::SIZE] = { 3, 2, 3 }; // value + CRC where the part has one
+static const uint32_t RUNTIME_CONVERSION_US = 10000;
+static const size_t SENSOR_BUS_LOAD_DEVICES = 0;
+static const uint32_t LOAD_DEVICE_CONVERSION_US = 12000;
+static SensorBus<> sensor_bus; // only touched by vSensorTask
 
 /*
-* @brief safe_printf is a non-blocking, thread safe way of printing to the console.
-* fill the buffer, put it in the print queue.
+* @brief add a sensor that isn't part of BuiltinSensors, polled after the built-in ones. Call before the scheduler starts.
+* @return false if the table is full
 */
-//void safe_printf(const char* format, ...) {
-//    PrintCommand cmd = { 0 };
-//    va_list args; // FIXME: not type safe
-//    va_start(args, format);
-//    vsnprintf(cmd.buffer, PRINT_BUF_SIZE, format, args);
-//    va_end(args);
-//    cmd.is_control_seq = false;
-//
-//    xQueueSend(xPrintQueue, &cmd, pdMS_TO_TICKS(10));
-//}
+static bool registerSensor(Sensor* sensor) {
+    if (runtime_sensor_count >= MAX_RUNTIME_SENSORS) {
+        return false;
+    }
+    runtime_sensors[runtime_sensor_count++] = sensor;
+    return true;
+}
 
 /*
-* @brief same idea as safe_printf, but more 'direct' because it handles control codes. 
+* @brief start from the default calibration of every sensor and replace the ones `path` has a curve for.
+* A missing file keeps the defaults, bad lines are logged and skipped. Call before the scheduler starts.
 */
-//void safe_print_control_code(const char* control_code, ...) {
-//    PrintCommand cmd = { 0 };
-//    strncpy(cmd.buffer, control_code, PRINT_BUF_SIZE);
-//    cmd.is_control_seq = true;
-//    xQueueSend(xPrintQueue, &cmd, pdMS_TO_TICKS(10));
-//}
+static void loadCalibration(const char* path) {
+    for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+        sensor_calibration[type] = DEFAULT_CALIBRATION[type];
+    }
+    FILE* in = path != NULL ? fopen(path, "r") : NULL;
+    if (in == NULL) {
+        return;
+    }
+    char line[256];
+    unsigned line_number = 0;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        line_number++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        CalibrationSpec spec;
+        size_t type = Sensor::TYPE_COUNT;
+        if (spec.parse(line)) {
+            for (type = 0; type < Sensor::TYPE_COUNT; type++) {
+                if (strcmp(spec.name, Sensor::typeName(static_cast<Sensor::Type>(type))) == 0) {
+                    break;
+                }
+            }
+        }
+        if (type == Sensor::TYPE_COUNT) {
+            pipeline_log.log(LOG_CALIBRATION_REJECTED, line_number);
+            continue;
+        }
+        sensor_calibration[type] = spec.build(DEFAULT_CALIBRATION[type]);
+        pipeline_log.log(LOG_CALIBRATION_LOADED, Sensor::typeName(static_cast<Sensor::Type>(type)), line_number);
+    }
+    fclose(in);
+}
 
-// Sensors, Queues and dashboard data instances all global for simplicity
-static TempSensor temp_sensor;
-static LightSensor light_sensor;
-static HumiditySensor humidity_sensor;
+// Raised by the processor's anomaly stage, travels on its own queue so alerts never wait behind bulk data
+struct AlertEvent {
+    Sensor::Type type;
+    AnomalyDetector::Kind kind;
+    float value;
+    float score;
+    TickType_t tick;
+};
 
 struct DashboardData {
     float temp;
     float humidity;
     float light;
     uint64_t uptime;
+    uint32_t alert_count;
+    AlertEvent last_alert;
+    HourlyQuantiles::Summary hourly[Sensor::TYPE_COUNT];
+    DerivedMetrics::Values derived;
+    TickType_t last_seen[Sensor::TYPE_COUNT]; // send tick of each sensor's latest sample
 };
 
 static DashboardData dashboard_data;
 static SemaphoreHandle_t xDashboardMutex;
+static TaskHandle_t xDashboardTaskHandle;
+
+// Direct-to-task notification slots, configTASK_NOTIFICATION_ARRAY_ENTRIES is 5.
+// Index 0 is left alone since the non-indexed notify API and stream buffers use it.
+static const UBaseType_t NOTIFY_INDEX_DASHBOARD = 1;
+
+// Minimum time between dashboard redraws, updates arriving faster than this are coalesced into one redraw.
+static const TickType_t DASHBOARD_MIN_REDRAW_INTERVAL = pdMS_TO_TICKS(250);
+
+/*
+* @brief low priority RTOS task that renders deferred log records and writes them out, one batch per LOG_FLUSH_PERIOD.
+* Also the logger's processed bus subscriber, its buffer is emptied every flush and summarized every LOG_SAMPLE_PERIOD.
+*/
+extern "C" void vLogTask(void* pvParameters) {
+    FILE* out = LOG_PATH != NULL ? fopen(LOG_PATH, "w") : stdout;
+    TickType_t xNextRelease = xTaskGetTickCount();
+    TickType_t xLastSampleLine = xNextRelease;
+    float latest[Sensor::TYPE_COUNT] = {};
+    unsigned samples = 0;
+
+    while (1) {
+        xTaskDelayUntil(&xNextRelease, LOG_FLUSH_PERIOD);
+        log_period.activated(xNextRelease, xTaskGetTickCount(), ulGetRunTimeCounterValue());
+        ProcessedPool::Handle handle;
+        while (processed_bus.receive(log_subscription, handle, 0)) {
+            const ProcessedSample& sample = processed_pool.get(handle);
+            pipeline.count(EDGE_LOG);
+            latest[static_cast<size_t>(sample.raw.type)] = sample.filtered;
+            samples++;
+            processed_bus.release(handle);
+        }
+        if (samples > 0 && xNextRelease - xLastSampleLine >= LOG_SAMPLE_PERIOD) {
+            pipeline_log.log(LOG_PROCESSED, latest[static_cast<size_t>(Sensor::Type::TEMPERATURE)],
+                latest[static_cast<size_t>(Sensor::Type::LIGHT)], latest[static_cast<size_t>(Sensor::Type::HUMIDITY)], samples);
+            xLastSampleLine = xNextRelease;
+            samples = 0;
+        }
+        if (out == NULL) {
+            pipeline_log.drain([](TickType_t, const char*) {}); // keep the ring moving so the drop count stays meaningful
+        }
+        else if (pipeline_log.drain([out](TickType_t tick, const char* line) {
+            fprintf(out, "[%10lu ms] %s\n", (unsigned long)(tick * portTICK_PERIOD_MS), line);
+        }) > 0) {
+            fflush(out);
+        }
+        log_period.completed(xTaskGetTickCount());
+    }
+}
 
 /*
-* @brief RTOS task for handling printing to console without blocking
+* @brief render every HTTP document from a dashboard snapshot and publish them. Runs in the dashboard task once per
+* update, however many clients are connected. The history gets a point every HTTP_HISTORY_INTERVAL.
 */
-//extern "C" void vPrintTask(void* pvParameters) {
-//    PrintCommand cmd;
-//    while (1) {
-//        if (xQueueReceive(xPrintQueue, &cmd, portMAX_DELAY) == pdPASS) {
-//            if (cmd.is_control_seq) {
-//                fputs(cmd.buffer, stdout); // control sequences should go through, no formatting
-//            }
-//            else {
-//                printf("%s",cmd.buffer);
-//            }
-//            fflush(stdout); // immediate output
-//        }
-//    }
-//}
+static void renderHttpDocuments(const DashboardData& snapshot, TickType_t now) {
+    struct HistoryPoint {
+        TickType_t tick;
+        float values[Sensor::TYPE_COUNT];
+    };
+    static HistoryPoint history[HTTP_HISTORY_LENGTH];
+    static size_t history_count = 0;
+    static size_t history_next = 0;
+    static TickType_t history_last = 0;
+
+    if (history_count == 0 || now - history_last >= HTTP_HISTORY_INTERVAL) {
+        history[history_next] = { now, { snapshot.temp, snapshot.light, snapshot.humidity } };
+        history_next = (history_next + 1) % HTTP_HISTORY_LENGTH;
+        history_count = history_count < HTTP_HISTORY_LENGTH ? history_count + 1 : HTTP_HISTORY_LENGTH;
+        history_last = now;
+    }
+    if (!http_server.begin()) {
+        return;
+    }
+    const float values[Sensor::TYPE_COUNT] = { snapshot.temp, snapshot.light, snapshot.humidity };
+    const unsigned long uptime_ms = static_cast<unsigned long>(snapshot.uptime * portTICK_PERIOD_MS);
+
+    http_server.append(HTTP_CURRENT, "{\"uptime_ms\":%lu", uptime_ms);
+    for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+        http_server.append(HTTP_CURRENT, ",\"%s\":%.3f", HTTP_SENSOR_KEYS[type], values[type]);
+    }
+    if (snapshot.derived.aligned) {
+        http_server.append(HTTP_CURRENT, ",\"vpd_kpa\":%.3f,\"dew_point\":%.2f", snapshot.derived.vpd, snapshot.derived.dew_point);
+    }
+    http_server.append(HTTP_CURRENT, ",\"dli_today\":%.3f,\"dli_yesterday\":%.3f,\"sensors\":{", snapshot.derived.dli_today,
+        snapshot.derived.dli_yesterday);
+    for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+        const HourlyQuantiles::Summary& hourly = snapshot.hourly[type];
+        http_server.append(HTTP_CURRENT, "%s\"%s\":{\"last_seen_ms\":%lu", type > 0 ? "," : "", HTTP_SENSOR_KEYS[type],
+            (unsigned long)(snapshot.last_seen[type] * portTICK_PERIOD_MS));
+        if (hourly.count > 0) {
+            http_server.append(HTTP_CURRENT, ",\"hour\":{\"p5\":%.3f,\"p50\":%.3f,\"p95\":%.3f,\"min\":%.3f,\"max\":%.3f,\"count\":%.0f}",
+                hourly.p5, hourly.p50, hourly.p95, hourly.min, hourly.max, hourly.count);
+        }
+        http_server.append(HTTP_CURRENT, "}");
+    }
+    http_server.append(HTTP_CURRENT, "},\"alerts\":{\"count\":%lu,\"dropped\":%lu", (unsigned long)snapshot.alert_count,
+        (unsigned long)alerts_dropped.load(std::memory_order_relaxed));
+    if (snapshot.alert_count > 0) {
+        const AlertEvent& alert = snapshot.last_alert;
+        http_server.append(HTTP_CURRENT, ",\"last\":{\"sensor\":\"%s\",\"kind\":\"%s\",\"value\":%.3f,\"score\":%.2f,\"at_ms\":%lu}",
+            HTTP_SENSOR_KEYS[static_cast<size_t>(alert.type)], AnomalyDetector::kindName(alert.kind), alert.value, alert.score,
+            (unsigned long)(alert.tick * portTICK_PERIOD_MS));
+    }
+    http_server.append(HTTP_CURRENT, "}}\n");
+
+    http_server.append(HTTP_HISTORY, "{\"interval_ms\":%lu,\"points\":[", (unsigned long)(HTTP_HISTORY_INTERVAL * portTICK_PERIOD_MS));
+    for (size_t i = 0; i < history_count; i++) {
+        const HistoryPoint& point = history[(history_next + HTTP_HISTORY_LENGTH - history_count + i) % HTTP_HISTORY_LENGTH];
+        http_server.append(HTTP_HISTORY, "%s{\"t_ms\":%lu", i > 0 ? "," : "", (unsigned long)(point.tick * portTICK_PERIOD_MS));
+        for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+            http_server.append(HTTP_HISTORY, ",\"%s\":%.3f", HTTP_SENSOR_KEYS[type], point.values[type]);
+        }
+        http_server.append(HTTP_HISTORY, "}");
+    }
+    http_server.append(HTTP_HISTORY, "]}\n");
+
+    RawChannel::Stats raw_stats = { 0, 0, 0 };
+    for (size_t shard = 0; shard < shard_router.shardCount(); shard++) {
+        RawChannel::Stats shard_stats = raw_channels[shard].stats();
+        raw_stats.sent += shard_stats.sent;
+        raw_stats.dropped += shard_stats.dropped;
+        raw_stats.merged += shard_stats.merged;
+    }
+    const PipelineLog::Stats log_stats = pipeline_log.stats();
+    const HttpServer::Stats http_stats = http_server.stats();
+    http_server.append(HTTP_STATS, "{\"edge\":{");
+    for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+        const DeadbandFilter::Stats edge = edge_filters[type].stats();
+        http_server.append(HTTP_STATS, "%s\"%s\":{\"read\":%lu,\"sent\":%lu,\"heartbeats\":%lu}", type > 0 ? "," : "",
+            HTTP_SENSOR_KEYS[type], (unsigned long)edge.offered, (unsigned long)edge.sent, (unsigned long)edge.heartbeats);
+    }
+    http_server.append(HTTP_STATS, "},\"raw\":{\"fused\":%s,\"sent\":%lu,\"dropped\":%lu,\"merged\":%lu,\"migrations\":%lu},\"lanes\":[",
+        pipeline.fused(EDGE_RAW) ? "true" : "false", (unsigned long)raw_stats.sent, (unsigned long)raw_stats.dropped, (unsigned long)raw_stats.merged,
+        (unsigned long)shard_router.migrations());
+    for (size_t lane = 0; lane < RAW_LANE_COUNT && !pipeline.fused(EDGE_RAW); lane++) { // fused there are no lanes to report
+        LatencyHistogram<64> latency;
+        for (size_t shard = 0; shard < shard_router.shardCount(); shard++) {
+            latency.merge(raw_lane_latency[shard][lane]);
+        }
+        http_server.append(HTTP_STATS, "%s{\"p50_ticks\":%lu,\"p99_ticks\":%lu,\"max_ticks\":%lu,\"samples\":%lu}", lane > 0 ? "," : "",
+            (unsigned long)latency.percentile(50.0f), (unsigned long)latency.percentile(99.0f), (unsigned long)latency.getMax(),
+            (unsigned long)latency.getCount());
+    }
+    http_server.append(HTTP_STATS, "],\"log\":{\"logged\":%lu,\"written\":%lu,\"dropped\":%lu}", (unsigned long)log_stats.logged,
+        (unsigned long)log_stats.written, (unsigned long)log_stats.dropped);
+    http_server.append(HTTP_STATS, ",\"telemetry\":{\"records\":%lu,\"frames\":%lu,\"errors\":%lu}", (unsigned long)telemetry_stats.records,
+        (unsigned long)telemetry_stats.frames, (unsigned long)telemetry_stats.write_errors);
+    http_server.append(HTTP_STATS, ",\"http\":{\"published\":%lu,\"skipped\":%lu,\"overflows\":%lu,\"clients\":%lu,\"rejected\":%lu,"
+        "\"requests\":%llu,\"bytes\":%llu}}\n", (unsigned long)http_stats.published, (unsigned long)http_stats.skipped,
+        (unsigned long)http_stats.overflows, (unsigned long)http_stats.clients, (unsigned long)http_stats.rejected,
+        (unsigned long long)http_stats.requests, (unsigned long long)http_stats.bytes);
+
+    http_server.append(HTTP_METRICS, "# TYPE plant_uptime_seconds gauge\nplant_uptime_seconds %.3f\n", uptime_ms / 1000.0);
+    http_server.append(HTTP_METRICS, "# TYPE plant_sensor_value gauge\n");
+    for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+        http_server.append(HTTP_METRICS, "plant_sensor_value{sensor=\"%s\"} %.3f\n", HTTP_SENSOR_KEYS[type], values[type]);
+    }
+    http_server.append(HTTP_METRICS, "# TYPE plant_sensor_hour_quantile gauge\n");
+    for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+        const HourlyQuantiles::Summary& hourly = snapshot.hourly[type];
+        if (hourly.count > 0) {
+            http_server.append(HTTP_METRICS, "plant_sensor_hour_quantile{sensor=\"%s\",quantile=\"0.05\"} %.3f\n"
+                "plant_sensor_hour_quantile{sensor=\"%s\",quantile=\"0.5\"} %.3f\n"
+                "plant_sensor_hour_quantile{sensor=\"%s\",quantile=\"0.95\"} %.3f\n",
+                HTTP_SENSOR_KEYS[type], hourly.p5, HTTP_SENSOR_KEYS[type], hourly.p50, HTTP_SENSOR_KEYS[type], hourly.p95);
+        }
+    }
+    if (snapshot.derived.aligned) {
+        http_server.append(HTTP_METRICS, "# TYPE plant_vpd_kpa gauge\nplant_vpd_kpa %.3f\n# TYPE plant_dew_point_celsius gauge\n"
+            "plant_dew_point_celsius %.2f\n", snapshot.derived.vpd, snapshot.derived.dew_point);
+    }
+    http_server.append(HTTP_METRICS, "# TYPE plant_dli_mol_m2 gauge\nplant_dli_mol_m2{day=\"today\"} %.3f\nplant_dli_mol_m2{day=\"yesterday\"} %.3f\n",
+        snapshot.derived.dli_today, snapshot.derived.dli_yesterday);
+    http_server.append(HTTP_METRICS, "# TYPE plant_alerts_total counter\nplant_alerts_total %lu\n"
+        "# TYPE plant_alerts_dropped_total counter\nplant_alerts_dropped_total %lu\n",
+        (unsigned long)snapshot.alert_count, (unsigned long)alerts_dropped.load(std::memory_order_relaxed));
+    http_server.append(HTTP_METRICS, "# TYPE plant_edge_readings_total counter\n");
+    for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+        const DeadbandFilter::Stats edge = edge_filters[type].stats();
+        http_server.append(HTTP_METRICS, "plant_edge_readings_total{sensor=\"%s\",outcome=\"read\"} %lu\n"
+            "plant_edge_readings_total{sensor=\"%s\",outcome=\"sent\"} %lu\n", HTTP_SENSOR_KEYS[type], (unsigned long)edge.offered,
+            HTTP_SENSOR_KEYS[type], (unsigned long)edge.sent);
+    }
+    http_server.append(HTTP_METRICS, "# TYPE plant_raw_samples_total counter\nplant_raw_samples_total{outcome=\"sent\"} %lu\n"
+        "plant_raw_samples_total{outcome=\"dropped\"} %lu\nplant_raw_samples_total{outcome=\"merged\"} %lu\n",
+        (unsigned long)raw_stats.sent, (unsigned long)raw_stats.dropped, (unsigned long)raw_stats.merged);
+    http_server.append(HTTP_METRICS, "# TYPE plant_log_records_total counter\nplant_log_records_total{outcome=\"written\"} %lu\n"
+        "plant_log_records_total{outcome=\"dropped\"} %lu\n", (unsigned long)log_stats.written, (unsigned long)log_stats.dropped);
+    http_server.append(HTTP_METRICS, "# TYPE plant_http_requests_total counter\nplant_http_requests_total %llu\n"
+        "# TYPE plant_http_snapshots_total counter\nplant_http_snapshots_total{outcome=\"published\"} %lu\n"
+        "plant_http_snapshots_total{outcome=\"skipped\"} %lu\n", (unsigned long long)http_stats.requests,
+        (unsigned long)http_stats.published, (unsigned long)http_stats.skipped);
+
+    http_server.publish();
+}
 
 /*
 * @brief RTOS task for displaying the dashboard, uses semaphores to ensure atomic access to
 * global dashboard_data struct.
+* Event driven: sleeps until the processor notifies it of new data, so an idle pipeline does no rendering work.
+* Bursts of updates are coalesced into at most one redraw per DASHBOARD_MIN_REDRAW_INTERVAL.
 */
 extern "C" void vDashboardTask(void* pvParameters) {
-    const TickType_t xUpdateFrequency = pdMS_TO_TICKS(1000);
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    vTaskDelay(pdMS_TO_TICKS(200));
+    const TickType_t redraw_interval = PLANT_MONITOR_VIRTUAL_TIME == 1 ? SOAK_REDRAW_INTERVAL : DASHBOARD_MIN_REDRAW_INTERVAL;
+    TickType_t xLastRedraw = xTaskGetTickCount() - redraw_interval;
+    DashboardData snapshot;
 
     while (1) {
-        if ( xSemaphoreTake(xDashboardMutex, pdMS_TO_TICKS(100)) == pdTRUE ){
-            // clear screen
-            printf("\033[2J\033[H");
-            // Print Dashboard
-            printf("=== Potted Plant Environmental Dashboard ===\n");
-            printf("Temperature: %.1f C\n", dashboard_data.temp);
-            printf("Light Level: %.1f lux\n", dashboard_data.light);
-            printf("Humidity:    %.1f %% \n", dashboard_data.humidity);
-            printf("Up Time: %llu ms", dashboard_data.uptime); 
-            xSemaphoreGive(xDashboardMutex);
+        ulTaskNotifyTakeIndexed(NOTIFY_INDEX_DASHBOARD, pdTRUE, portMAX_DELAY);
+
+        // Too soon since the last redraw, wait out the interval and fold any updates that arrive meanwhile into this one
+        TickType_t xSinceRedraw = xTaskGetTickCount() - xLastRedraw;
+        if (xSinceRedraw < redraw_interval) {
+            vTaskDelay(redraw_interval - xSinceRedraw);
+            ulTaskNotifyTakeIndexed(NOTIFY_INDEX_DASHBOARD, pdTRUE, 0);
+        }
+
+        // Copy out under the mutex and print afterwards, the processor never waits on console output
+        if (xSemaphoreTake(xDashboardMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+            // the notification is already consumed, give it back so this update is retried instead of lost
+            xTaskNotifyGiveIndexed(xTaskGetCurrentTaskHandle(), NOTIFY_INDEX_DASHBOARD);
+            continue;
+        }
+        snapshot = dashboard_data;
+        xSemaphoreGive(xDashboardMutex);
+        xLastRedraw = xTaskGetTickCount();
+        if (HTTP_PORT != 0) {
+            renderHttpDocuments(snapshot, xLastRedraw);
+        }
+
+        // clear screen
+        printf("\033[2J\033[H");
+        // Print Dashboard
+        printf("=== Potted Plant Environmental Dashboard ===\n");
+        printf("Temperature: %.1f C\n", snapshot.temp);
+        printf("Light Level: %.1f lux\n", snapshot.light);
+        printf("Humidity:    %.1f %% \n", snapshot.humidity);
+        printf("Up Time: %llu ms\n", snapshot.uptime);
+        if (snapshot.derived.aligned) {
+            printf("VPD:         %.2f kPa   Dew point: %.1f C\n", snapshot.derived.vpd, snapshot.derived.dew_point);
+        }
+        printf("DLI:         %.2f mol/m2 today (yesterday %.2f)\n", snapshot.derived.dli_today, snapshot.derived.dli_yesterday);
+        for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+            const HourlyQuantiles::Summary& hourly = snapshot.hourly[type];
+            if (hourly.count > 0) {
+                printf("%-11s 1h  p5 %.1f  p50 %.1f  p95 %.1f  min %.1f  max %.1f\n", Sensor::typeName(static_cast<Sensor::Type>(type)),
+                    hourly.p5, hourly.p50, hourly.p95, hourly.min, hourly.max);
+            }
+        }
+        if (snapshot.alert_count > 0) {
+            const AlertEvent& alert = snapshot.last_alert;
+            printf("Alerts: %lu (dropped %lu) last: %s %s value %.2f score %.1f at %lu ms\n",
+                (unsigned long)snapshot.alert_count, (unsigned long)alerts_dropped.load(std::memory_order_relaxed), Sensor::typeName(alert.type),
+                AnomalyDetector::kindName(alert.kind), alert.value, alert.score, (unsigned long)(alert.tick * portTICK_PERIOD_MS));
+        }
+        uint32_t edge_read = 0;
+        uint32_t edge_sent = 0;
+        for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+            DeadbandFilter::Stats edge = edge_filters[type].stats();
+            const TickType_t heartbeat = edge_filters[type].config().heartbeat;
+            const bool stale = edge.sent > 0 && xLastRedraw - snapshot.last_seen[type] > heartbeat + heartbeat / 2;
+            printf("Edge %-11s read: %lu sent: %lu (%.0f%% held back) heartbeats: %lu%s\n", Sensor::typeName(static_cast<Sensor::Type>(type)),
+                (unsigned long)edge.offered, (unsigned long)edge.sent, edge.offered > 0 ? 100.0f * (edge.offered - edge.sent) / edge.offered : 0.0f,
+                (unsigned long)edge.heartbeats, stale ? "  STALE" : "");
+            edge_read += edge.offered;
+            edge_sent += edge.sent;
+        }
+        printf("Edge total read: %lu sent: %lu, raw path traffic down %.0f%%\n", (unsigned long)edge_read, (unsigned long)edge_sent,
+            edge_read > 0 ? 100.0f * (edge_read - edge_sent) / edge_read : 0.0f);
+        RawChannel::Stats raw_stats = { 0, 0, 0 };
+        for (size_t shard = 0; shard < shard_router.shardCount(); shard++) {
+            RawChannel::Stats shard_stats = raw_channels[shard].stats();
+            raw_stats.sent += shard_stats.sent;
+            raw_stats.dropped += shard_stats.dropped;
+            raw_stats.merged += shard_stats.merged;
+            printf("Shard %u processed: %lu\n", (unsigned)shard, (unsigned long)shard_router.completedCount(shard));
+        }
+        if (pipeline.fused(EDGE_RAW)) {
+            printf("Raw path   direct call into the processor, no lanes or backpressure\n");
+        }
+        else {
+            printf("Raw path   sent: %lu dropped: %lu merged: %lu migrations: %lu\n", (unsigned long)raw_stats.sent,
+                (unsigned long)raw_stats.dropped, (unsigned long)raw_stats.merged, (unsigned long)shard_router.migrations());
+        }
+        for (size_t lane = 0; lane < RAW_LANE_COUNT && !pipeline.fused(EDGE_RAW); lane++) {
+            LatencyHistogram<64> latency;
+            for (size_t shard = 0; shard < shard_router.shardCount(); shard++) {
+                latency.merge(raw_lane_latency[shard][lane]);
+            }
+            printf("Lane %u latency p50: %lu p99: %lu max: %lu ticks (%lu samples)\n", (unsigned)lane,
+                (unsigned long)latency.percentile(50.0f), (unsigned long)latency.percentile(99.0f),
+                (unsigned long)latency.getMax(), (unsigned long)latency.getCount());
+        }
+        const auto& wakeups = wakeup_accounting.report(ulGetRunTimeCounterValue(), xTaskGetIdleTaskHandle(), WAKEUP_REPORT_WINDOW);
+        printf("Wakeups    ticks: %.0f/s (suppressed %.0f/s) task wakeups: %.0f/s idle: %.0f%% (asleep %.0f%%)\n",
+            wakeups.ticks, wakeups.suppressed, wakeups.wakeups, wakeups.idle * 100.0f, wakeups.asleep * 100.0f);
+        printf("          ");
+        for (size_t i = 0; i < wakeups.tasks; i++) {
+            printf(" %s %.1f", pcTaskGetName(static_cast<TaskHandle_t>(wakeups.task_rates[i].task)), wakeups.task_rates[i].wakeups);
+        }
+        printf("\n");
+        for (const PeriodMonitor<>* monitor : { &sensor_period, &log_period }) {
+            PeriodMonitor<>::Stats period = monitor->stats();
+            printf("Period [%-6s] %lu ms  runs: %lu late max: %lu ms  jitter p50: %lu us p99: %lu us max: %lu us  misses: %lu overruns: %lu\n",
+                period.name, (unsigned long)(period.period * portTICK_PERIOD_MS), (unsigned long)period.activations,
+                (unsigned long)(period.max_lateness * portTICK_PERIOD_MS), (unsigned long)(period.jitter_p50 * (1000000 / RUN_TIME_COUNTER_HZ)),
+                (unsigned long)(period.jitter_p99 * (1000000 / RUN_TIME_COUNTER_HZ)), (unsigned long)(period.jitter_max * (1000000 / RUN_TIME_COUNTER_HZ)),
+                (unsigned long)period.deadline_misses, (unsigned long)period.overruns);
+        }
+        if (SENSOR_IO != SensorIo::DIRECT) {
+            SensorBus<>::Stats bus = sensor_bus.stats();
+            printf("Sensor bus [%s] devices: %lu cycles: %lu  cycle last: %.2f ms avg: %.2f ms max: %.2f ms  %.1f transactions/cycle\n",
+                SENSOR_IO == SensorIo::BUS_BLOCKING ? "blocking" : "overlapped", (unsigned long)bus.devices, (unsigned long)bus.cycles,
+                bus.last_cycle_us / 1000.0f, bus.cycles > 0 ? bus.total_cycle_us / 1000.0f / bus.cycles : 0.0f, bus.max_cycle_us / 1000.0f,
+                bus.cycles > 0 ? (float)bus.transactions / bus.cycles : 0.0f);
+        }
+        pipeline.report([](const char* line) { printf("%s\n", line); }, static_cast<float>(xLastRedraw) / configTICK_RATE_HZ);
+        PipelineLog::Stats log_stats = pipeline_log.stats();
+        printf("Log        logged: %lu written: %lu dropped: %lu\n", (unsigned long)log_stats.logged,
+            (unsigned long)log_stats.written, (unsigned long)log_stats.dropped);
+        if (telemetry_stats.records > 0) {
+            printf("Telemetry  records: %lu frames: %lu errors: %lu  %.1f bytes/sample (CSV %.1f)\n",
+                (unsigned long)telemetry_stats.records, (unsigned long)telemetry_stats.frames, (unsigned long)telemetry_stats.write_errors,
+                (float)telemetry_stats.bytes / telemetry_stats.records, (float)telemetry_stats.text_bytes / telemetry_stats.records);
+        }
+        RawSamplePool::Stats raw_pool_stats = raw_pool.stats();
+        ProcessedPool::Stats processed_pool_stats = processed_pool.stats();
+        printf("Pools      raw %lu/%lu (peak %lu, exhausted %lu) processed %lu/%lu (peak %lu, exhausted %lu)\n",
+            (unsigned long)raw_pool_stats.in_use, (unsigned long)raw_pool_stats.capacity,
+            (unsigned long)raw_pool_stats.high_water, (unsigned long)raw_pool_stats.exhausted,
+            (unsigned long)processed_pool_stats.in_use, (unsigned long)processed_pool_stats.capacity,
+            (unsigned long)processed_pool_stats.high_water, (unsigned long)processed_pool_stats.exhausted);
+        for (size_t i = 0; i < processed_bus.subscriberCount(); i++) {
+            ProcessedBus::Stats stats = processed_bus.stats(static_cast<ProcessedBus::Handle>(i));
+            printf("Bus [%-10s] delivered: %lu dropped: %lu lag: %lu (max %lu)\n", stats.name,
+                (unsigned long)stats.delivered, (unsigned long)stats.dropped,
+                (unsigned long)stats.lag, (unsigned long)stats.max_lag);
         }
-        vTaskDelayUntil(&xLastWakeTime, xUpdateFrequency);
     }
 }
 
 /*
-* @brief RTOS task for polling data from the sensor suite. Round robin access when reading from sensors. 
-* Takes in data and places it in the RawDataQueue to be processed.
+* @brief low priority RTOS task that batches processed samples into binary telemetry frames.
+* A frame goes out when TELEMETRY_MAX_RECORDS are collected or TELEMETRY_FLUSH_PERIOD after its first record.
 */
-extern "C" void vSensorTask(void* pvParameters) {
-    Sensor* sensors[] = { &temp_sensor, &light_sensor, &humidity_sensor };
-    const TickType_t xDelay = pdMS_TO_TICKS(100); // poll every 100 ms
-    size_t idx = 0;
+extern "C" void vTelemetryTask(void* pvParameters) {
+    static TelemetrySink sink;
+    static TelemetryRecord batch[TELEMETRY_MAX_RECORDS];
+    static uint8_t frame[TELEMETRY_MAX_ENCODED];
+    size_t count = 0;
+    uint16_t sequence = 0;
+    TickType_t xBatchStarted = 0;
+
+    sink.open(TELEMETRY_SINK, TELEMETRY_PATH);
 
     while (1) {
-        Sensor::Data data = sensors[idx]->read();
-        xQueueSend(xRawDataQueue, &data, portMAX_DELAY);
-        idx = (idx + 1) % 3; // alternate sensors
-        vTaskDelay(xDelay);
+        TickType_t xTimeout = portMAX_DELAY;
+        if (count > 0) {
+            TickType_t xAge = xTaskGetTickCount() - xBatchStarted;
+            xTimeout = xAge < TELEMETRY_FLUSH_PERIOD ? TELEMETRY_FLUSH_PERIOD - xAge : 0;
+        }
+
+        ProcessedPool::Handle handle;
+        if (processed_bus.receive(telemetry_subscription, handle, xTimeout)) {
+            const ProcessedSample& sample = processed_pool.get(handle);
+            pipeline.count(EDGE_TELEMETRY);
+            TelemetryRecord& record = batch[count++];
+            record = { static_cast<uint8_t>(sample.raw.type), sample.published, sample.raw.value, sample.filtered };
+            processed_bus.release(handle);
+            if (TELEMETRY_COMPARE_TEXT) {
+                telemetry_stats.text_bytes += snprintf(NULL, 0, "%u,%lu,%.3f,%.3f\n", (unsigned)record.sensor_id,
+                    (unsigned long)record.timestamp, record.raw, record.filtered);
+            }
+            if (count == 1) {
+                xBatchStarted = xTaskGetTickCount();
+            }
+        }
+
+        if (count == TELEMETRY_MAX_RECORDS || (count > 0 && xTaskGetTickCount() - xBatchStarted >= TELEMETRY_FLUSH_PERIOD)) {
+            size_t len = telemetryEncodeFrame(batch, count, sequence++, frame);
+            if (!sink.write(frame, len)) {
+                telemetry_stats.write_errors++;
+                pipeline_log.log(LOG_TELEMETRY_WRITE_FAILED, static_cast<unsigned>(sequence - 1));
+            }
+            telemetry_stats.records += count;
+            telemetry_stats.frames++;
+            telemetry_stats.bytes += len;
+            count = 0;
+        }
     }
 }
 
 /*
-* @brief RTOS task that takes in data from the RawDataQueue and applys various filters to the data. 
-* Places processed data on the ProcessedDataQueue.
-* Currently nothing is utilizing the data in the ProcessedDataQueue, will be utilized for 'live' sensor viewing or other tasks.
+* @brief lowest priority RTOS task that periodically writes the trace recorder's snapshot to TRACE_SNAPSHOT_PATH.
 */
-extern "C" void vProcessorTask(void* pvParameters) {
-    static MovingAverage<float, 5> temperature_filter;
-    static MovingAverage<float, 5> humidity_filter;
-    static MovingAverage<float, 5> light_filter;
-    Sensor::Data data;
+extern "C" void vTraceDumpTask(void* pvParameters) {
+    while (1) {
+        vTaskDelay(TRACE_DUMP_PERIOD);
+        traceDumpSnapshot(TRACE_SNAPSHOT_PATH);
+    }
+}
+
+/*
+* @brief RTOS task for alert events from the anomaly stage. Runs above the sensor and processor tasks so an alert
+* is handled as soon as it is raised, independent of how far behind the processed bus is.
+*/
+extern "C" void vAlertTask(void* pvParameters) {
+    AlertEvent alert;
 
     while (1) {
-        if (xQueueReceive(xRawDataQueue, &data, portMAX_DELAY) == pdPASS) {            
+        if (xQueueReceive(xAlertQueue, &alert, portMAX_DELAY) == pdPASS) {
             if (xSemaphoreTake(xDashboardMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-                dashboard_data.uptime = xTaskGetTickCount(); 
-                switch (data.type) {
-                case Sensor::Type::TEMPERATURE:                 
-                    dashboard_data.temp = temperature_filter.addSample(data.value);
-                    break;
-                case Sensor::Type::LIGHT:                                       
-                    dashboard_data.light = light_filter.addSample(data.value);
-                    break;
-                case Sensor::Type::HUMIDITY:                                      
-                    dashboard_data.humidity = humidity_filter.addSample(data.value);
-                    break;
-                default:
-                    break;
-                }
+                dashboard_data.alert_count++;
+                dashboard_data.last_alert = alert;
                 xSemaphoreGive(xDashboardMutex);
+                xTaskNotifyGiveIndexed(xDashboardTaskHandle, NOTIFY_INDEX_DASHBOARD);
             }
-            xQueueSend(xProcessedDataQueue, &data, pdMS_TO_TICKS(100));
         }
     }
 }
 
+/*
+* @brief feed a reading to a sensor filter, overloaded for the float and fixed point filter types.
+* Each overload only looks at the reading in its own format, the fixed point one filters in integers.
+* @return the filtered value as float for display and the processed bus
+*/
+static float filterSample(MovingAverage<float, FILTER_WINDOW>& filter, float value, Q16_16) {
+    return filter.addSample(value);
+}
+
+static float filterSample(MovingAverage<Q16_16, FILTER_WINDOW>& filter, float, Q16_16 fixed) {
+    return filter.addSample(fixed).toFloat();
+}
+
+/*
+* @brief picks the raw lane for a reading. Humidity jumps skip the queue, light is the high volume bulk stream.
+* Only called from vSensorTask, the static state is not shared.
+*/
+static size_t classifyLane(const Sensor::Data& data) {
+    static float last_humidity = NAN;
+
+    switch (data.type) {
+    case Sensor::Type::HUMIDITY: {
+        bool urgent = !std::isnan(last_humidity) && fabsf(data.value - last_humidity) >= HUMIDITY_URGENT_DELTA;
+        last_humidity = data.value;
+        return urgent ? LANE_URGENT : LANE_NORMAL;
+    }
+    case Sensor::Type::LIGHT:
+        return LANE_BULK;
+    default:
+        return LANE_NORMAL;
+    }
+}
+
+/*
+* @brief end of a soak run: throughput, drops and memory high water marks over the simulated period.
+*/
+static void printSoakReport(double wall_seconds) {
+    const double simulated = static_cast<double>(xTaskGetTickCount()) / configTICK_RATE_HZ;
+    printf("\n=== Soak run: %.2f simulated days in %.1f s (%.0fx real time), seed %u ===\n", simulated / 86400.0, wall_seconds,
+        wall_seconds > 0.0 ? simulated / wall_seconds : 0.0, SIMULATION_SEED);
+
+    uint32_t read = 0;
+    uint32_t sent = 0;
+    for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+        read += edge_filters[type].stats().offered;
+        sent += edge_filters[type].stats().sent;
+    }
+    uint32_t processed = 0;
+    for (size_t shard = 0; shard < shard_router.shardCount(); shard++) {
+        processed += shard_router.completedCount(shard);
+    }
+    printf("Throughput  read: %lu sent: %lu processed: %lu (%.1f samples per simulated s, %.0f per wall clock s)\n",
+        (unsigned long)read, (unsigned long)sent, (unsigned long)processed, processed / simulated, processed / wall_seconds);
+    pipeline.report([](const char* line) { printf("  %s\n", line); }, static_cast<float>(simulated));
+
+    RawChannel::Stats raw = { 0, 0, 0 };
+    for (size_t shard = 0; shard < shard_router.shardCount(); shard++) {
+        raw.dropped += raw_channels[shard].stats().dropped;
+        raw.merged += raw_channels[shard].stats().merged;
+    }
+    PipelineLog::Stats log_stats = pipeline_log.stats();
+    printf("Drops       raw: %lu (merged %lu) alerts: %lu log: %lu\n", (unsigned long)raw.dropped, (unsigned long)raw.merged,
+        (unsigned long)alerts_dropped.load(std::memory_order_relaxed), (unsigned long)log_stats.dropped);
+    for (size_t i = 0; i < processed_bus.subscriberCount(); i++) {
+        ProcessedBus::Stats bus = processed_bus.stats(static_cast<ProcessedBus::Handle>(i));
+        printf("  bus [%s] dropped: %lu max lag: %lu\n", bus.name, (unsigned long)bus.dropped, (unsigned long)bus.max_lag);
+    }
+
+    RawSamplePool::Stats raw_pool_stats = raw_pool.stats();
+    ProcessedPool::Stats processed_pool_stats = processed_pool.stats();
+    printf("Memory      raw pool peak %lu/%lu (exhausted %lu) processed pool peak %lu/%lu (exhausted %lu)\n",
+        (unsigned long)raw_pool_stats.high_water, (unsigned long)raw_pool_stats.capacity, (unsigned long)raw_pool_stats.exhausted,
+        (unsigned long)processed_pool_stats.high_water, (unsigned long)processed_pool_stats.capacity, (unsigned long)processed_pool_stats.exhausted);
+    // blocks still allocated is the leak check, a run that only allocates at startup keeps it flat
+    const size_t blocks = kernel_heap_blocks.load();
+    const size_t freed = kernel_heap_freed.load();
+    printf("            kernel heap allocated %lu bytes in %lu blocks since start, %lu freed, %lu still allocated\n",
+        (unsigned long)kernel_heap_allocated.load(), (unsigned long)blocks, (unsigned long)freed, (unsigned long)(blocks - freed));
+    printf("  stack headroom (words):");
+    pipeline.forEachTask([](TaskHandle_t task) {
+        printf(" %s %lu", pcTaskGetName(task), (unsigned long)uxTaskGetStackHighWaterMark(task));
+    });
+    printf(" IDLE %lu\n", (unsigned long)uxTaskGetStackHighWaterMark(xTaskGetIdleTaskHandle()));
+    for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+        const HourlyQuantiles::Summary& hourly = dashboard_data.hourly[type];
+        printf("Final %-11s 1h p5 %.2f p50 %.2f p95 %.2f\n", Sensor::typeName(static_cast<Sensor::Type>(type)), hourly.p5, hourly.p50, hourly.p95);
+    }
+    printf("Final DLI   yesterday %.2f mol/m2\n", dashboard_data.derived.dli_yesterday);
+}
+
+/*
+* @brief runs the soak: sleeps for SOAK_DURATION of simulated time, prints the report and ends the process.
+*/
+extern "C" void vSoakTask(void* pvParameters) {
+    const auto started = std::chrono::steady_clock::now();
+    TickType_t xStart = xTaskGetTickCount();
+    xTaskDelayUntil(&xStart, SOAK_DURATION);
+
+    vTaskSuspendAll(); // freeze the pipeline while the report reads its state
+    pipeline_log.drain([](TickType_t, const char*) {});
+    printSoakReport(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count());
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+/*
+* @brief the processor stage: applys various filters to a sample of a sensor owned by `shard`.
+* Publishes processed data on the processed_bus, publishing never blocks so a slow subscriber can't throttle processing.
+* Runs in the shard's processor task, or in the sensor task when the pipeline plan fuses the two. The sensor task
+* outranks the dashboard, fused it skips the dashboard update rather than wait on the dashboard's mutex.
+*/
+static void processSample(size_t shard, const RawSample& sample, size_t lane) {
+    const uint32_t waited = xTaskGetTickCount() - sample.enqueued;
+    raw_lane_latency[shard][lane].record(waited);
+    const Sensor::Data& data = sample.data;
+    const size_t sensor_id = static_cast<size_t>(data.type);
+    traceRawReceive(static_cast<uint8_t>(sensor_id), lane, waited);
+    const TickType_t now = xTaskGetTickCount();
+
+    // Readings the edge held back were within its deadband of the previous sample, replay that value in their
+    // place so the filter window and the quantile weights keep counting readings rather than sends.
+    // The anomaly detector only sees real readings, held values would shrink its variance estimate.
+    if (sample.suppressed > 0) {
+        const float held = held_values[sensor_id];
+        for (uint32_t i = 0; i < sample.suppressed && i < FILTER_WINDOW; i++) {
+            filterSample(sensor_filters[sensor_id], held, held_fixed[sensor_id]);
+        }
+        sensor_quantiles[sensor_id].add(now, held, static_cast<float>(sample.suppressed));
+    }
+    held_values[sensor_id] = data.value;
+    held_fixed[sensor_id] = sample.fixed;
+
+    const float filtered = filterSample(sensor_filters[sensor_id], data.value, sample.fixed);
+    traceFilterUpdate(static_cast<uint8_t>(sensor_id), filtered);
+
+    sensor_quantiles[sensor_id].add(now, data.value);
+    bool refresh_quantiles = now - quantiles_refreshed[sensor_id] >= QUANTILE_REFRESH_PERIOD;
+    HourlyQuantiles::Summary hourly;
+    if (refresh_quantiles) {
+        hourly = sensor_quantiles[sensor_id].summarize(now);
+        quantiles_refreshed[sensor_id] = now;
+    }
+
+    AnomalyDetector::Result anomaly = anomaly_detectors[sensor_id].update(data.value);
+    if (anomaly.kind != AnomalyDetector::Kind::NONE) {
+        AlertEvent alert = { data.type, anomaly.kind, data.value, anomaly.score, xTaskGetTickCount() };
+        pipeline_log.log(LOG_ANOMALY, Sensor::typeName(data.type), AnomalyDetector::kindName(anomaly.kind), data.value, anomaly.score);
+        if (xQueueSend(xAlertQueue, &alert, 0) != pdPASS) {
+            alerts_dropped.fetch_add(1, std::memory_order_relaxed);
+            pipeline_log.log(LOG_ALERT_DROPPED, Sensor::typeName(data.type));
+        }
+        else {
+            pipeline.count(EDGE_ALERTS);
+        }
+    }
+
+    if (xSemaphoreTake(xDashboardMutex, pipeline.fused(EDGE_RAW) ? 0 : pdMS_TO_TICKS(10)) == pdTRUE) {
+        dashboard_data.uptime = xTaskGetTickCount(); 
+        plant_metrics.update(data.type, filtered, sample.enqueued);
+        dashboard_data.derived = plant_metrics.values();
+        dashboard_data.last_seen[sensor_id] = sample.enqueued;
+        if (refresh_quantiles) {
+            dashboard_data.hourly[sensor_id] = hourly;
+        }
+        switch (data.type) {
+        case Sensor::Type::TEMPERATURE:                 
+            dashboard_data.temp = filtered;
+            break;
+        case Sensor::Type::LIGHT:                                       
+            dashboard_data.light = filtered;
+            break;
+        case Sensor::Type::HUMIDITY:                                      
+            dashboard_data.humidity = filtered;
+            break;
+        default:
+            break;
+        }
+        xSemaphoreGive(xDashboardMutex);
+        xTaskNotifyGiveIndexed(xDashboardTaskHandle, NOTIFY_INDEX_DASHBOARD);
+        pipeline.count(EDGE_DASHBOARD);
+    }
+    ProcessedPool::Handle out = processed_pool.acquire();
+    if (out != ProcessedPool::INVALID_HANDLE) {
+        processed_pool.get(out) = { data, filtered, static_cast<uint32_t>(xTaskGetTickCount()) };
+        processed_bus.publish(out);
+        processed_pool.release(out); // subscribers hold their own references now
+    }
+}
+
+/*
+* @brief hand a sample that passed the sensor edge to the processor stage of the shard owning its sensor,
+* through the shard's raw channel or, with the raw edge fused, by calling it directly.
+*/
+static void forwardSample(const Sensor::Data& data, Q16_16 fixed, size_t lane, uint32_t suppressed) {
+    const size_t shard = shard_router.route(static_cast<size_t>(data.type));
+    pipeline.count(EDGE_RAW);
+    if (pipeline.fused(EDGE_RAW)) {
+        const RawSample sample = { data, data.value, data.value, 1, xTaskGetTickCount(), suppressed, fixed };
+        processSample(shard, sample, lane);
+        shard_router.completed(shard);
+    }
+    else {
+        const uint32_t dropped = raw_channels[shard].send(data, lane, suppressed, fixed);
+        if (dropped > 0) {
+            shard_router.discarded(shard, dropped);
+        }
+    }
+    traceRawSend(static_cast<uint8_t>(data.type), lane);
+}
+
+/*
+* @brief run time counter in microseconds, the time base of the simulated sensor bus.
+*/
+static uint64_t busMicros() {
+    return static_cast<uint64_t>(ulGetRunTimeCounterValue()) * (1000000 / RUN_TIME_COUNTER_HZ);
+}
+
+/*
+* @brief RTOS task for polling data from the sensor suite. Round robin access when reading from sensors directly.
+* Takes in data and routes it to the raw channel of the shard owning that sensor, never blocks unless the BLOCK policy is selected.
+* When the plan fuses the raw edge the processor stage runs right here instead, without the queue hop.
+* Readings are calibrated here, then those inside a sensor's deadband are held back, the next sample sent carries how many were.
+* Being the only producer, it also drives shard rebalancing.
+* Released every SENSOR_POLL_PERIOD on an absolute schedule, so read and send time don't stretch the sampling period.
+* With a bus SENSOR_IO mode every release is one bus cycle: conversions are started, the task sleeps until the next one
+* completes and sends each reading as soon as its device has been read.
+*/
+extern "C" void vSensorTask(void* pvParameters) {
+    const size_t sensor_count = BuiltinSensors::SIZE + runtime_sensor_count;
+    size_t idx = 0;
+    TickType_t xLastRebalance = xTaskGetTickCount();
+    TickType_t xNextRelease = xTaskGetTickCount();
+    // a calibrated reading, held back or passed on by the sensor's deadband
+    auto offer = [](const Sensor::Data& data, Q16_16 fixed) {
+        DeadbandFilter::Decision edge = edge_filters[static_cast<size_t>(data.type)].offer(data.value, xTaskGetTickCount());
+        if (!edge.send) {
+            return;
+        }
+        forwardSample(data, fixed, classifyLane(data), edge.suppressed);
+    };
+    auto send = [&offer](Sensor::Data data) {
+        traceSensorRead(static_cast<uint8_t>(data.type), data.value);
+        data.value = sensor_calibration[static_cast<size_t>(data.type)].apply(data.value);
+        offer(data, Q16_16());
+    };
+    auto sendFixed = [&offer](Sensor::FixedData reading) {
+        const Q16_16 fixed = sensor_calibration[static_cast<size_t>(reading.type)].applyFixed(reading.value);
+        const Sensor::Data data = { fixed.toFloat(), reading.type, reading.timestamp }; // for the float-only stages
+        traceSensorRead(static_cast<uint8_t>(data.type), reading.value.toFloat());
+        offer(data, fixed);
+    };
+    // one reading of sensor `index` through the filter path PROCESSOR_FIXED_POINT selects
+    auto poll = [&send, &sendFixed](size_t index) {
+        if (PROCESSOR_FIXED_POINT) {
+            if (!sensor_set.readFixedAt(index, sendFixed)) {
+                sendFixed(runtime_sensors[index - BuiltinSensors::SIZE]->readFixed());
+            }
+        }
+        else if (!sensor_set.readAt(index, send)) {
+            send(runtime_sensors[index - BuiltinSensors::SIZE]->read());
+        }
+    };
+
+    while (1) {
+        xTaskDelayUntil(&xNextRelease, SENSOR_POLL_PERIOD);
+        sensor_period.activated(xNextRelease, xTaskGetTickCount(), ulGetRunTimeCounterValue());
+        if (SENSOR_IO == SensorIo::DIRECT) {
+            poll(idx);
+        }
+        else {
+            sensor_bus.startCycle(busMicros());
+            while (!sensor_bus.cycleDone()) {
+                const uint64_t now = busMicros();
+                const uint64_t next = sensor_bus.nextEvent();
+                if (next > now) {
+                    vTaskDelay(pdMS_TO_TICKS((next - now + 999) / 1000)); // round up, waking early only costs another sleep
+                }
+                // a result only exists once its read transaction is off the bus, wait for that before passing it on
+                std::array<uint8_t, BuiltinSensors::SIZE + MAX_RUNTIME_SENSORS> done;
+                size_t done_count = 0;
+                uint64_t read_at = 0;
+                sensor_bus.complete(busMicros(), [&](size_t device, uint64_t at) {
+                    if (device < sensor_count) {
+                        done[done_count++] = static_cast<uint8_t>(device);
+                        read_at = at;
+                    }
+                });
+                const uint64_t after = busMicros();
+                if (read_at > after) {
+                    vTaskDelay(pdMS_TO_TICKS((read_at - after + 999) / 1000));
+                }
+                for (size_t i = 0; i < done_count; i++) {
+                    poll(done[i]);
+                }
+            }
+        }
+        if (LIGHT_FLOOD_BURST > 0) {
+            // the burst is one sensor's readings back to back, calibrate them as a batch
+            std::array<Sensor::Data, LIGHT_FLOOD_BURST> flood;
+            std::array<float, LIGHT_FLOOD_BURST> values;
+            for (uint32_t i = 0; i < LIGHT_FLOOD_BURST; i++) {
+                flood[i] = sensor_set.get<LightSensor>().read();
+                values[i] = flood[i].value;
+            }
+            sensor_calibration[static_cast<size_t>(Sensor::Type::LIGHT)].applyBatch(values.data(), values.data(), values.size());
+            for (uint32_t i = 0; i < LIGHT_FLOOD_BURST; i++) {
+                flood[i].value = values[i];
+                forwardSample(flood[i], PROCESSOR_FIXED_POINT ? Q16_16::fromFloat(values[i]) : Q16_16(), LANE_BULK, 0);
+            }
+        }
+        if (PROCESSOR_WORK_STEALING && xTaskGetTickCount() - xLastRebalance >= SHARD_REBALANCE_PERIOD) {
+            if (shard_router.rebalance()) {
+                pipeline_log.log(LOG_SHARD_MIGRATION, shard_router.migrations());
+            }
+            xLastRebalance = xTaskGetTickCount();
+        }
+        idx = (idx + 1) % sensor_count; // alternate sensors
+        sensor_period.completed(xTaskGetTickCount());
+    }
+}
+
+/*
+* @brief RTOS task that takes in data from its shard's raw channel and runs the processor stage on it.
+* One instance per shard, pvParameters carries the shard index. Only filters of sensors routed to this shard are touched.
+* Not created when the pipeline plan fuses the processor into the sensor task.
+*/
+extern "C" void vProcessorTask(void* pvParameters) {
+    const size_t shard = reinterpret_cast<uintptr_t>(pvParameters);
+    RawChannel& channel = raw_channels[shard];
+    RawChannel::Handle handle;
+    size_t lane;
+
+    while (1) {
+        if (channel.receive(handle, portMAX_DELAY, &lane)) {
+            const RawSample& sample = channel.get(handle);
+            const uint32_t readings = sample.count; // a coalesced block completes every reading merged into it
+            processSample(shard, sample, lane);
+            channel.release(handle);
+            shard_router.completed(shard, readings);
+        }
+    }
+}
+
+/*
+* @brief declare the pipeline's stages and edges. Rates are upper bounds, the deadband only lowers them.
+*/
+static void buildPipeline() {
+    using Graph = decltype(pipeline);
+    const float polls = static_cast<float>(configTICK_RATE_HZ) / SENSOR_POLL_PERIOD;
+    const float samples = polls * (SENSOR_IO == SensorIo::DIRECT ? 1 : BuiltinSensors::SIZE + runtime_sensor_count) * (1 + LIGHT_FLOOD_BURST);
+
+    pipeline.stage(STAGE_SENSOR, { "Sensor", Graph::Kind::SOURCE, polls, SENSOR_STAGE_COST_US, Graph::NONE, vSensorTask, 3, 1, NULL });
+    pipeline.stage(STAGE_PROCESSOR, { "Processor", Graph::Kind::FILTER, samples, PROCESSOR_STAGE_COST_US, Graph::NONE, vProcessorTask, 2,
+        shard_router.shardCount(), NULL });
+    pipeline.stage(STAGE_ALERT, { "Alert", Graph::Kind::SINK, 1.0f, 10, Graph::ISOLATED, vAlertTask, 4, 1, NULL }); // above everything else
+    pipeline.stage(STAGE_DASHBOARD, { "Dashboard", Graph::Kind::SINK, static_cast<float>(configTICK_RATE_HZ) / DASHBOARD_MIN_REDRAW_INTERVAL, 2000, Graph::BLOCKING, vDashboardTask,
+        1, 1, &xDashboardTaskHandle });
+    pipeline.stage(STAGE_LOG, { "Log", Graph::Kind::SINK, static_cast<float>(configTICK_RATE_HZ) / LOG_FLUSH_PERIOD, 200, Graph::BLOCKING, vLogTask, 1, 1, NULL });
+    // lanes and a backpressure policy other than BLOCK only exist in the raw channel, fusing would silently drop them
+    const bool raw_policy = RAW_LANE_COUNT > 1 || RAW_BACKPRESSURE_POLICY != RawChannel::Policy::BLOCK;
+    pipeline.edge(EDGE_RAW, STAGE_SENSOR, STAGE_PROCESSOR, "raw", [] {
+        for (size_t shard = 0; shard < shard_router.shardCount(); shard++) {
+            raw_channels[shard].create(&raw_pool, RAW_QUEUE_DEPTH, RAW_BACKPRESSURE_POLICY, RAW_LANE_COUNT, RAW_DRAIN_POLICY, RAW_LANE_WEIGHTS);
+        }
+    }, raw_policy ? Graph::QUEUED : Graph::NONE);
+    pipeline.edge(EDGE_ALERTS, STAGE_PROCESSOR, STAGE_ALERT, "alerts", [] {
+        xAlertQueue = xQueueCreate(ALERT_QUEUE_DEPTH, sizeof(AlertEvent));
+    });
+    pipeline.edge(EDGE_DASHBOARD, STAGE_PROCESSOR, STAGE_DASHBOARD, "dashboard");
+
+    log_subscription = processed_bus.subscribe("log", LOG_BUFFER_DEPTH, ProcessedBus::OverflowPolicy::DROP_OLDEST);
+    if (log_subscription != ProcessedBus::INVALID_HANDLE) {
+        pipeline.edge(EDGE_LOG, STAGE_PROCESSOR, STAGE_LOG, "processed");
+    }
+
+    if (TELEMETRY_SINK != TelemetrySink::Kind::NONE) {
+        telemetry_subscription = processed_bus.subscribe("telemetry", TELEMETRY_BUFFER_DEPTH, ProcessedBus::OverflowPolicy::DROP_OLDEST);
+        if (telemetry_subscription != ProcessedBus::INVALID_HANDLE) {
+            pipeline.stage(STAGE_TELEMETRY, { "Telemetry", Graph::Kind::SINK, samples, 20, Graph::BLOCKING, vTelemetryTask, 1, 1, NULL });
+            pipeline.edge(EDGE_TELEMETRY, STAGE_PROCESSOR, STAGE_TELEMETRY, "processed");
+        }
+    }
+    if (configUSE_TRACE_FACILITY == 1) {
+        pipeline.stage(STAGE_TRACE_DUMP, { "TraceDump", Graph::Kind::SINK, static_cast<float>(configTICK_RATE_HZ) / TRACE_DUMP_PERIOD, 0, Graph::BLOCKING, vTraceDumpTask, 1, 1, NULL });
+    }
+    if (PLANT_MONITOR_VIRTUAL_TIME == 1) {
+        pipeline.stage(STAGE_SOAK, { "Soak", Graph::Kind::SINK, 0.0f, 0, Graph::BLOCKING, vSoakTask, 1, 1, NULL });
+    }
+}
+
 /*
 * @brief FreeRTOS setup and entrypoint.
 * initilized data queues, creates our semaphore, registers tasks, then starts the scheduler.
 */
 void vMain(void) {
-    xRawDataQueue = xQueueCreate(5, sizeof(Sensor::Data));
-    xProcessedDataQueue = xQueueCreate(5, sizeof(Sensor::Data));
-
+    traceStart(); // no-op unless built with PLANT_MONITOR_TRACE=1
+    srand(SIMULATION_SEED);
+    loadCalibration(CALIBRATION_PATH);
+    shard_router.init(PROCESSOR_SHARDS);
+    for (size_t type = 0; type < Sensor::TYPE_COUNT; type++) {
+        anomaly_detectors[type].configure(ANOMALY_CONFIG[type]);
+        sensor_quantiles[type].setSliceTicks(QUANTILE_SLICE_TICKS);
+        edge_filters[type].configure(EDGE_DEADBAND[type]);
+    }
+    sensor_bus.configure(SENSOR_IO == SensorIo::BUS_BLOCKING ? SensorBus<>::Mode::BLOCKING : SensorBus<>::Mode::OVERLAPPED, SENSOR_BUS_TIMING);
+    for (size_t i = 0; i < BuiltinSensors::SIZE; i++) {
+        sensor_bus.attach(BUILTIN_CONVERSION_US[i], BUILTIN_READ_BYTES[i]);
+    }
+    for (size_t i = 0; i < runtime_sensor_count; i++) {
+        sensor_bus.attach(RUNTIME_CONVERSION_US, 4);
+    }
+    for (size_t i = 0; i < SENSOR_BUS_LOAD_DEVICES; i++) {
+        sensor_bus.attach(LOAD_DEVICE_CONVERSION_US, 3);
+    }
+    const uint32_t counter_per_tick = RUN_TIME_COUNTER_HZ / configTICK_RATE_HZ;
+    const uint32_t jitter_bucket = static_cast<uint32_t>(static_cast<uint64_t>(RUN_TIME_COUNTER_HZ) * JITTER_BUCKET_US / 1000000);
+    sensor_period.configure("Sensor", SENSOR_POLL_PERIOD, SENSOR_POLL_DEADLINE, counter_per_tick, jitter_bucket);
+    log_period.configure("Log", LOG_FLUSH_PERIOD, LOG_FLUSH_PERIOD, counter_per_tick, jitter_bucket);
+    plant_metrics.configure(DERIVED_CONFIG);
     xDashboardMutex = xSemaphoreCreateMutex();
-    xTaskCreate(vDashboardTask, "Dashboard", 1024, NULL, 1, NULL);
-    xTaskCreate(vProcessorTask, "Processor", 1024, NULL, 2, NULL);
-    xTaskCreate(vSensorTask, "Sensor", 1024, NULL, 3, NULL);
 
+    buildPipeline();
+    pipeline.plan(PIPELINE_FUSE_BUDGET);
+    pipeline.create();
+    if (HTTP_PORT != 0) {
+        if (http_server.start(HTTP_PORT, HTTP_ROUTES)) {
+            pipeline_log.log(LOG_HTTP_STARTED, static_cast<unsigned>(HTTP_PORT));
+        }
+        else {
+            pipeline_log.log(LOG_HTTP_FAILED, static_cast<unsigned>(HTTP_PORT));
+        }
+    }
+
+    pipeline_log.log(LOG_STARTED, static_cast<unsigned>(shard_router.shardCount()), static_cast<unsigned>(BuiltinSensors::SIZE + runtime_sensor_count));
     vTaskStartScheduler();
 }
 
@@ -185,6 +1207,62 @@ int main( void )
 
 // Stubbing to stop linker from whining
 void vConfigureTimerForRunTimeStats(void) { }
+
+// Also the trace recorder's timestamp source on Win32 (TRC_HWTC_FREQ_HZ), counts at RUN_TIME_COUNTER_HZ.
+// In virtual time it is derived from the tick, the FromISR read because it is also called from the task switch hook.
+configRUN_TIME_COUNTER_TYPE ulGetRunTimeCounterValue(void) {
+    if (PLANT_MONITOR_VIRTUAL_TIME == 1) {
+        return static_cast<configRUN_TIME_COUNTER_TYPE>(xTaskGetTickCountFromISR()) * (RUN_TIME_COUNTER_HZ / configTICK_RATE_HZ);
+    }
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / (1000000 / RUN_TIME_COUNTER_HZ);
+}
+
+void vHeapAccountingMalloc(void* pvAddress, size_t xSize) {
+    if (pvAddress != NULL) {
+        kernel_heap_allocated.fetch_add(xSize, std::memory_order_relaxed);
+        kernel_heap_blocks.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void vHeapAccountingFree(void* pvAddress) {
+    if (pvAddress != NULL) {
+        kernel_heap_freed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void vApplicationTickHook(void) {
+    wakeup_accounting.tick();
+}
+
+void vWakeupAccountingSwitchedIn(void* pvTask) {
+    wakeup_accounting.switchedIn(pvTask, xTaskGetIdleTaskHandle(), ulGetRunTimeCounterValue());
+}
+
+#if ( configUSE_TICKLESS_IDLE == 1 ) && defined( _WIN32 )
+/*
+* @brief tickless idle for the simulation, called by the idle task with the scheduler suspended. Blocks the idle
+* thread in Windows instead of letting it spin, waking a tick early so the tick that unblocks a task isn't overslept.
+* In virtual time the idle period isn't slept at all: the tick count and the run time counter jump over it, the kernel
+* pends the final tick so the task that was waiting runs as soon as the scheduler resumes.
+*/
+void vSimulatedSuppressTicksAndSleep(unsigned long ulExpectedIdleTime) {
+    eSleepModeStatus status = eTaskConfirmSleepModeStatus();
+    if (status == eAbortSleep || ulExpectedIdleTime < 2) {
+        return;
+    }
+    wakeup_accounting.sleepBegin(ulGetRunTimeCounterValue());
+    if (PLANT_MONITOR_VIRTUAL_TIME == 1) {
+        if (status != eNoTasksWaitingTimeout) { // nothing would ever wake up, leave it to the real tick
+            vTaskStepTick(ulExpectedIdleTime);
+        }
+    }
+    else {
+        std::this_thread::sleep_for(std::chrono::milliseconds((ulExpectedIdleTime - 1) * portTICK_PERIOD_MS));
+    }
+    wakeup_accounting.sleepEnd(ulGetRunTimeCounterValue());
+}
+#endif
 void vAssertCalled(unsigned long ulLine, const char* const pcFileName) {
     printf("Asserted at: %s Line: %lu\n", pcFileName, ulLine);
 }
\ No newline at end of file
@@ -1,31 +1,68 @@
 #pragma once
 #include <array>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
 #include <concepts>
+#include <type_traits>
+#include "fixed_point.hpp"
 
 template<typename T>
 concept Arithmetic = std::is_arithmetic_v<T>;
 
+/*
+* @brief rounding division of an integer accumulator by the window size, N a power of two becomes a shift.
+*/
+template<size_t N, typename Acc>
+constexpr Acc roundingDivide(Acc sum) {
+    constexpr bool POWER_OF_TWO = (N & (N - 1)) == 0;
+    if constexpr (POWER_OF_TWO && std::is_signed_v<Acc>) {
+        constexpr int SHIFT = std::countr_zero(N);
+        if constexpr (SHIFT == 0) {
+            return sum;
+        }
+        else {
+            constexpr Acc HALF = Acc(1) << (SHIFT - 1);
+            return sum >= 0 ? (sum + HALF) >> SHIFT : -((-sum + HALF) >> SHIFT);
+        }
+    }
+    else if constexpr (std::is_signed_v<Acc>) {
+        constexpr Acc HALF = static_cast<Acc>(N / 2);
+        return sum >= 0 ? (sum + HALF) / static_cast<Acc>(N) : (sum - HALF) / static_cast<Acc>(N);
+    }
+    else {
+        return (sum + static_cast<Acc>(N / 2)) / static_cast<Acc>(N);
+    }
+}
+
 template<typename T, size_t N>
-    requires Arithmetic<T>
+    requires Arithmetic<T> || FixedPoint<T>
 
 class MovingAverage {
 public:
-    MovingAverage() : m_samples{ 0 }, m_sum(0), m_idx(0) {}
+    // Integer samples sum into 64 bits so large windows can't overflow the accumulator
+    using Accumulator = std::conditional_t<std::is_integral_v<T>, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>, T>;
+
+    MovingAverage() : m_samples{ 0 }, m_sum(0), m_average(0) {}
 
     /*
-    * @brief 
-    * @return
+    * @brief add a sample, dropping the oldest one once the window is full.
+    * @return the new average, rounded to nearest for integer types
     */
     T addSample(const T sample) {
         m_sum -= m_samples[m_idx];
         m_sum += sample;
         m_samples[m_idx] = sample;
         m_idx = (m_idx + 1) % N; // Circular buffer
-        m_average = m_sum / static_cast<T>(N);
+        if constexpr (std::is_integral_v<T>) {
+            m_average = static_cast<T>(roundingDivide<N>(m_sum));
+        }
+        else {
+            m_average = m_sum / static_cast<T>(N);
+        }
         return m_average;
     }
-    
+
     /*
     * @brief
     * @return
@@ -42,11 +79,55 @@ public:
         m_samples.fill(0);
         m_sum = 0;
         m_idx = 0;
+        m_average = 0;
     }
 
 private:
     std::array<T, N> m_samples; // using std::array because its stack allocated, no dynamic memory action inside of tasks.
     size_t m_idx = 0;
-    T m_sum;
+    Accumulator m_sum;
     T m_average; // used to prevent recalculations
-};
\ No newline at end of file
+};
+
+/*
+* @brief: MovingAverage over Q-format fixed point samples for FPU-less targets. Samples are kept as raw integers,
+* the sum is accumulated in 64 bits and divided with rounding, a shift when N is a power of two. No float math at all.
+*/
+template<int FracBits, typename Storage, size_t N>
+class MovingAverage<Fixed<FracBits, Storage>, N> {
+public:
+    using Value = Fixed<FracBits, Storage>;
+    using Accumulator = typename Value::wide_type;
+
+    MovingAverage() : m_samples{ 0 }, m_sum(0) {}
+
+    /*
+    * @brief add a sample, dropping the oldest one once the window is full.
+    * @return the new average
+    */
+    Value addSample(const Value sample) {
+        m_sum -= m_samples[m_idx];
+        m_sum += sample.raw();
+        m_samples[m_idx] = sample.raw();
+        m_idx = (m_idx + 1) % N; // Circular buffer
+        m_average = Value::fromRaw(static_cast<Storage>(roundingDivide<N>(m_sum)));
+        return m_average;
+    }
+
+    Value getAverage() const {
+        return m_average;
+    }
+
+    void reset() {
+        m_samples.fill(0);
+        m_sum = 0;
+        m_idx = 0;
+        m_average = Value();
+    }
+
+private:
+    std::array<Storage, N> m_samples;
+    size_t m_idx = 0;
+    Accumulator m_sum;
+    Value m_average;
+};
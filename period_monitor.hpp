@@ -0,0 +1,100 @@
+#pragma once
+extern "C" {
+    #include "FreeRTOS.h"
+}
+#include "latency_histogram.hpp"
+#include <cstdint>
+
+/*
+* @brief: PeriodMonitor instruments one periodic task released by xTaskDelayUntil.
+* Release times come from the kernel's schedule (the wake tick xTaskDelayUntil advanced to), so drift between
+* the tick and the run time counter never accumulates into the figures:
+*   lateness  - ticks from release to the task actually running
+*   jitter    - |actual activation interval - period| in run time counter units, bucketed into a histogram
+*   deadline miss - a job that completed more than `deadline` ticks after its release
+*   overrun   - a job that completed at or after the next release, xTaskDelayUntil then returns without blocking
+* Only the monitored task writes, readers get a best effort snapshot like the other pipeline stats.
+*/
+template<size_t Buckets = 64>
+class PeriodMonitor {
+public:
+    struct Stats {
+        const char* name;
+        TickType_t period;
+        uint32_t activations;
+        uint32_t deadline_misses;
+        uint32_t overruns;
+        TickType_t max_lateness;
+        uint32_t jitter_p50;  // run time counter units, resolution is the bucket width
+        uint32_t jitter_p99;
+        uint32_t jitter_max;  // exact
+    };
+
+    /*
+    * @param counter_per_tick run time counter units per kernel tick
+    * @param bucket_width run time counter units per jitter histogram bucket
+    */
+    void configure(const char* name, TickType_t period, TickType_t deadline, uint32_t counter_per_tick, uint32_t bucket_width) {
+        m_name = name;
+        m_period = period;
+        m_deadline = deadline;
+        m_nominal = static_cast<uint64_t>(period) * counter_per_tick;
+        m_bucket_width = bucket_width > 0 ? bucket_width : 1;
+    }
+
+    /*
+    * @brief call as soon as the task runs after xTaskDelayUntil.
+    * @param release the wake tick xTaskDelayUntil advanced to
+    */
+    void activated(TickType_t release, TickType_t now, uint64_t counter) {
+        m_release = release;
+        TickType_t lateness = now - release;
+        if (lateness > m_max_lateness) {
+            m_max_lateness = lateness;
+        }
+        if (m_activations > 0) {
+            uint64_t interval = counter - m_last_counter;
+            uint64_t jitter = interval > m_nominal ? interval - m_nominal : m_nominal - interval;
+            m_jitter.record(static_cast<uint32_t>(jitter / m_bucket_width));
+            if (jitter > m_jitter_max) {
+                m_jitter_max = static_cast<uint32_t>(jitter);
+            }
+        }
+        m_last_counter = counter;
+        m_activations++;
+    }
+
+    /*
+    * @brief call when the job's work is done, before blocking for the next release.
+    */
+    void completed(TickType_t now) {
+        TickType_t response = now - m_release;
+        if (response > m_deadline) {
+            m_deadline_misses++;
+        }
+        if (response >= m_period) {
+            m_overruns++;
+        }
+    }
+
+    Stats stats() const {
+        return { m_name, m_period, m_activations, m_deadline_misses, m_overruns, m_max_lateness,
+            m_jitter.percentile(50.0f) * m_bucket_width, m_jitter.percentile(99.0f) * m_bucket_width, m_jitter_max };
+    }
+
+private:
+    const char* m_name = "";
+    TickType_t m_period = 1;
+    TickType_t m_deadline = 1;
+    uint64_t m_nominal = 0;
+    uint32_t m_bucket_width = 1;
+
+    TickType_t m_release = 0;
+    uint64_t m_last_counter = 0;
+    uint32_t m_activations = 0;
+    uint32_t m_deadline_misses = 0;
+    uint32_t m_overruns = 0;
+    TickType_t m_max_lateness = 0;
+    uint32_t m_jitter_max = 0;
+    LatencyHistogram<Buckets> m_jitter;
+};
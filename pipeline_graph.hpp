@@ -0,0 +1,231 @@
+#pragma once
+extern "C" {
+    #include "FreeRTOS.h"
+    #include "task.h"
+}
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/*
+* @brief: PipelineGraph holds the pipeline topology in one place: stages (sources, filters, sinks) with their expected
+* input rate and per item cost, and the edges between them. plan() decides which edges stay queue hops and which become
+* direct calls, create() then builds the queues and tasks the plan needs.
+* An edge is fused, i.e. the downstream stage runs inside the upstream stage's task, when the downstream stage:
+*   - has that edge as its only input (merging inputs needs a queue)
+*   - is neither BLOCKING (waits on I/O or the console) nor ISOLATED (needs its own priority)
+*   - runs as a single instance (sharded stages need a task per shard)
+*   - keeps the fused task's estimated load (sum of rate * cost) within the fuse budget
+* and the edge isn't QUEUED: its queue carries policy (priority lanes, backpressure) a direct call would drop.
+* Stages and edges are addressed by caller chosen IDs below MaxStages/MaxEdges, IDs that are never declared are skipped,
+* so optional stages are simply not declared. Declare, plan and create before the scheduler starts.
+* count() is safe from any task, the report shows per edge throughput since start.
+*/
+template<size_t MaxStages = 16, size_t MaxEdges = 16>
+class PipelineGraph {
+public:
+    enum class Kind { SOURCE, FILTER, SINK };
+
+    enum Flags : uint32_t {
+        NONE = 0,
+        BLOCKING = 1 << 0,
+        ISOLATED = 1 << 1,
+        QUEUED = 1 << 2,          // edges only
+    };
+
+    struct Stage {
+        const char* name;
+        Kind kind;
+        float rate_hz;            // items in per second, or activations for a source
+        uint32_t cost_us;         // per item
+        uint32_t flags;
+        TaskFunction_t task;      // body when the stage gets a task of its own, pvParameters is the instance index
+        UBaseType_t priority;
+        size_t instances;
+        TaskHandle_t* handle;     // optional, receives the (first) instance's handle
+    };
+
+    struct Edge {
+        size_t from;
+        size_t to;
+        const char* name;
+        void (*create)();         // builds the queue when the edge isn't fused, may be NULL
+        uint32_t flags;
+    };
+
+    void stage(size_t id, const Stage& stage) {
+        m_stages[id] = { stage, true, id, 0.0f };
+    }
+
+    void edge(size_t id, size_t from, size_t to, const char* name, void (*create)() = NULL, uint32_t flags = NONE) {
+        m_edges[id].spec = { from, to, name, create, flags };
+        m_edges[id].declared = true;
+        m_edges[id].fused = false;
+    }
+
+    /*
+    * @param fuse_budget fraction of one CPU a task with fused stages may be estimated to use
+    */
+    void plan(float fuse_budget) {
+        for (size_t id = 0; id < MaxStages; id++) {
+            StageSlot& slot = m_stages[id];
+            slot.task = id;
+            slot.load = slot.declared ? slot.spec.rate_hz * slot.spec.cost_us / 1e6f : 0.0f;
+        }
+        for (size_t id = 0; id < MaxEdges; id++) {
+            EdgeSlot& edge = m_edges[id];
+            if (!edge.declared || (edge.spec.flags & QUEUED) != 0) {
+                continue;
+            }
+            const Stage& to = m_stages[edge.spec.to].spec;
+            const size_t from_task = m_stages[edge.spec.from].task;
+            const size_t to_task = m_stages[edge.spec.to].task;
+            if (to.kind == Kind::SOURCE || inputs(edge.spec.to) != 1 || (to.flags & (BLOCKING | ISOLATED)) != 0 ||
+                to.instances != 1 || from_task == to_task) {
+                continue;
+            }
+            const float load = m_stages[from_task].load + m_stages[to_task].load;
+            if (load > fuse_budget) {
+                continue;
+            }
+            for (StageSlot& slot : m_stages) {
+                if (slot.task == to_task) {
+                    slot.task = from_task;
+                }
+            }
+            m_stages[from_task].load = load;
+            edge.fused = true;
+        }
+    }
+
+    /*
+    * @brief create the queues of unfused edges, then one task per instance of every stage that leads a task.
+    * @return false if a task couldn't be created
+    */
+    bool create() {
+        for (const EdgeSlot& edge : m_edges) {
+            if (edge.declared && !edge.fused && edge.spec.create != NULL) {
+                edge.spec.create();
+            }
+        }
+        for (size_t id = 0; id < MaxStages; id++) {
+            const StageSlot& slot = m_stages[id];
+            if (!slot.declared || slot.task != id || slot.spec.task == NULL) {
+                continue;
+            }
+            for (size_t instance = 0; instance < slot.spec.instances; instance++) {
+                char name[configMAX_TASK_NAME_LEN];
+                if (slot.spec.instances > 1) {
+                    snprintf(name, sizeof(name), "%s%u", slot.spec.name, (unsigned)instance);
+                }
+                else {
+                    snprintf(name, sizeof(name), "%s", slot.spec.name);
+                }
+                TaskHandle_t handle = NULL;
+                if (xTaskCreate(slot.spec.task, name, TASK_STACK_DEPTH, reinterpret_cast<void*>(instance),
+                    slot.spec.priority, &handle) != pdPASS) {
+                    return false;
+                }
+                if (instance == 0 && slot.spec.handle != NULL) {
+                    *slot.spec.handle = handle;
+                }
+                if (m_task_count < m_tasks.size()) {
+                    m_tasks[m_task_count++] = handle;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool fused(size_t edge) const {
+        return m_edges[edge].fused;
+    }
+
+    /*
+    * @return true if the stage runs in a task of its own rather than inside another stage's task
+    */
+    bool ownsTask(size_t stage) const {
+        return m_stages[stage].declared && m_stages[stage].task == stage;
+    }
+
+    /*
+    * @brief call f(TaskHandle_t) for every task create() made, e.g. to check stack high water marks.
+    */
+    template<typename F>
+    void forEachTask(F&& f) const {
+        for (size_t i = 0; i < m_task_count; i++) {
+            f(m_tasks[i]);
+        }
+    }
+
+    void count(size_t edge, uint32_t items = 1) {
+        m_edges[edge].items.fetch_add(items, std::memory_order_relaxed);
+    }
+
+    /*
+    * @brief describe the layout, one line per task and per edge, handing each line to write(line).
+    * @param seconds time since start, for the edge throughput
+    */
+    template<typename Writer>
+    void report(Writer&& write, float seconds) const {
+        char line[160];
+        for (size_t id = 0; id < MaxStages; id++) {
+            const StageSlot& leader = m_stages[id];
+            if (!leader.declared || leader.task != id) {
+                continue;
+            }
+            int len = snprintf(line, sizeof(line), "Task %-10s x%u prio %u load %.2f%%:", leader.spec.name,
+                (unsigned)leader.spec.instances, (unsigned)leader.spec.priority, leader.load * 100.0f);
+            for (const StageSlot& member : m_stages) {
+                if (member.declared && member.task == id && len > 0 && len < static_cast<int>(sizeof(line))) {
+                    len += snprintf(line + len, sizeof(line) - len, " %s", member.spec.name);
+                }
+            }
+            write(line);
+        }
+        for (const EdgeSlot& edge : m_edges) {
+            if (!edge.declared) {
+                continue;
+            }
+            uint32_t items = edge.items.load(std::memory_order_relaxed);
+            snprintf(line, sizeof(line), "Edge %-10s %s -> %s %s  %lu items %.1f/s", edge.spec.name,
+                m_stages[edge.spec.from].spec.name, m_stages[edge.spec.to].spec.name, edge.fused ? "direct call" : "task hop",
+                (unsigned long)items, seconds > 0.0f ? items / seconds : 0.0f);
+            write(line);
+        }
+    }
+
+private:
+    static constexpr configSTACK_DEPTH_TYPE TASK_STACK_DEPTH = 1024;
+
+    struct StageSlot {
+        Stage spec;
+        bool declared;
+        size_t task;  // ID of the stage whose task runs this one
+        float load;   // estimated, summed over the task at its leader
+    };
+
+    struct EdgeSlot {
+        Edge spec;
+        bool declared;
+        bool fused;
+        std::atomic<uint32_t> items{ 0 };
+    };
+
+    size_t inputs(size_t stage) const {
+        size_t count = 0;
+        for (const EdgeSlot& edge : m_edges) {
+            if (edge.declared && edge.spec.to == stage) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    std::array<StageSlot, MaxStages> m_stages{};
+    std::array<EdgeSlot, MaxEdges> m_edges{};
+    std::array<TaskHandle_t, 2 * MaxStages> m_tasks{};
+    size_t m_task_count = 0;
+};
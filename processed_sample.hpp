@@ -0,0 +1,14 @@
+#pragma once
+#include "sensor.hpp"
+
+/*
+* @brief: A sample after it has been through the processor, carries the raw reading alongside the filtered value
+* so downstream consumers don't need their own copy of the filter state.
+* published is the kernel tick the processor published it at. raw.timestamp is the sensor's own read counter,
+* not a time, consumers that need one use published.
+*/
+struct ProcessedSample {
+    Sensor::Data raw;
+    float filtered;
+    uint32_t published;
+};
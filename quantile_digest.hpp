@@ -0,0 +1,277 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/*
+* @brief: TDigest is a fixed memory merging t-digest (Dunning) for streaming quantiles.
+* Incoming values are buffered, when the buffer fills it is merged with the centroids and recompressed so that
+* centroids near the tails stay small (accurate p5/p95) and centroids around the median may grow large.
+* With Compression = d at most about d/2 centroids survive a compression, storage is sized for d.
+* Digests merge without loss of the size bound, so per shard or per time slice digests can be combined.
+* tools/bench_quantiles.cpp checks the hourly configuration's rank error and speed against sorting the exact window.
+*/
+template<size_t Compression = 100, size_t BufferSize = 32>
+class TDigest {
+public:
+    static constexpr size_t MAX_CENTROIDS = Compression;
+
+    /*
+    * @param weight how many observations `value` stands for, e.g. readings held back at the sensor edge
+    */
+    void add(float value, float weight = 1.0f) {
+        m_buffer[m_buffered++] = { value, weight };
+        m_buffered_weight += weight;
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+        if (m_buffered == BufferSize) {
+            flush();
+        }
+    }
+
+    /*
+    * @brief fold another digest into this one.
+    */
+    void merge(const TDigest& other) {
+        std::array<Centroid, MAX_CENTROIDS + MAX_CENTROIDS + BufferSize + BufferSize> scratch;
+        size_t n = gather(scratch.data());
+        n += other.gather(scratch.data() + n);
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        compress(scratch.data(), n);
+    }
+
+    /*
+    * @brief estimate the value at quantile q in [0, 1] by interpolating between centroid centres.
+    * @return NAN if the digest is empty
+    */
+    float quantile(float q) {
+        flush();
+        if (m_count == 0) {
+            return NAN;
+        }
+        if (m_count == 1 || q <= 0.0f) {
+            return q <= 0.0f ? m_min : m_centroids[0].mean;
+        }
+        if (q >= 1.0f) {
+            return m_max;
+        }
+
+        const float target = q * m_total;
+        // Below the first centroid's centre, interpolate from the minimum
+        float left_center = m_centroids[0].weight / 2.0f;
+        if (target < left_center) {
+            return m_min + (m_centroids[0].mean - m_min) * (target / left_center);
+        }
+        float cumulative = m_centroids[0].weight;
+        for (size_t i = 1; i < m_count; i++) {
+            float right_center = cumulative + m_centroids[i].weight / 2.0f;
+            if (target < right_center) {
+                float t = (target - left_center) / (right_center - left_center);
+                return m_centroids[i - 1].mean + t * (m_centroids[i].mean - m_centroids[i - 1].mean);
+            }
+            cumulative += m_centroids[i].weight;
+            left_center = right_center;
+        }
+        // Above the last centre, interpolate towards the maximum
+        float t = (target - left_center) / (m_total - left_center);
+        return m_centroids[m_count - 1].mean + t * (m_max - m_centroids[m_count - 1].mean);
+    }
+
+    float getMin() const {
+        return m_min;
+    }
+
+    float getMax() const {
+        return m_max;
+    }
+
+    float getCount() const {
+        return m_total + m_buffered_weight;
+    }
+
+    void reset() {
+        m_count = 0;
+        m_buffered = 0;
+        m_buffered_weight = 0.0f;
+        m_total = 0.0f;
+        m_min = std::numeric_limits<float>::infinity();
+        m_max = -std::numeric_limits<float>::infinity();
+    }
+
+private:
+    struct Centroid {
+        float mean;
+        float weight;
+    };
+
+    void flush() {
+        if (m_buffered == 0) {
+            return;
+        }
+        std::array<Centroid, MAX_CENTROIDS + BufferSize> scratch;
+        compress(scratch.data(), gather(scratch.data()));
+    }
+
+    /*
+    * @brief copy centroids and buffered values into `out` as weighted points.
+    * @return number of points written
+    */
+    size_t gather(Centroid* out) const {
+        size_t n = 0;
+        for (size_t i = 0; i < m_count; i++) {
+            out[n++] = m_centroids[i];
+        }
+        for (size_t i = 0; i < m_buffered; i++) {
+            out[n++] = m_buffer[i];
+        }
+        return n;
+    }
+
+    /*
+    * @brief sort points and greedily merge neighbours while the merged centroid spans at most one unit of the
+    * k1 scale function k(q) = d / (2 pi) * asin(2q - 1), which keeps tail centroids small.
+    */
+    void compress(Centroid* points, size_t n) {
+        m_buffered = 0;
+        m_buffered_weight = 0.0f;
+        m_count = 0;
+        if (n == 0) {
+            m_total = 0.0f;
+            return;
+        }
+        std::sort(points, points + n, [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+
+        float total = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            total += points[i].weight;
+        }
+        m_total = total;
+
+        const float normalizer = static_cast<float>(Compression) / (2.0f * 3.14159265f);
+        float so_far = 0.0f;
+        float q_limit = qLimit(0.0f, normalizer);
+        Centroid current = points[0];
+        for (size_t i = 1; i < n; i++) {
+            float proposed = current.weight + points[i].weight;
+            if ((so_far + proposed) / total <= q_limit) {
+                current.mean += (points[i].mean - current.mean) * points[i].weight / proposed;
+                current.weight = proposed;
+            }
+            else {
+                so_far += current.weight;
+                emit(current);
+                current = points[i];
+                q_limit = qLimit(so_far / total, normalizer);
+            }
+        }
+        emit(current);
+    }
+
+    void emit(const Centroid& centroid) {
+        if (m_count < MAX_CENTROIDS) {
+            m_centroids[m_count++] = centroid;
+            return;
+        }
+        // Storage bound reached (only with pathological weights), fold into the last centroid rather than lose weight
+        Centroid& last = m_centroids[m_count - 1];
+        float weight = last.weight + centroid.weight;
+        last.mean += (centroid.mean - last.mean) * centroid.weight / weight;
+        last.weight = weight;
+    }
+
+    static float qLimit(float q0, float normalizer) {
+        float k = normalizer * asinf(2.0f * q0 - 1.0f) + 1.0f;
+        float limit_k = normalizer * 1.5707963f; // k at q = 1
+        if (k >= limit_k) {
+            return 1.0f;
+        }
+        return (sinf(k / normalizer) + 1.0f) / 2.0f;
+    }
+
+    std::array<Centroid, MAX_CENTROIDS> m_centroids{};
+    std::array<Centroid, BufferSize> m_buffer{};
+    size_t m_count = 0;
+    size_t m_buffered = 0;
+    float m_buffered_weight = 0.0f;
+    float m_total = 0.0f;
+    float m_min = std::numeric_limits<float>::infinity();
+    float m_max = -std::numeric_limits<float>::infinity();
+};
+
+/*
+* @brief: WindowedDigest answers quantile queries over a sliding time window without keeping the samples.
+* The window is split into Slices digests, each covering slice_ticks. The oldest slice is cleared when time moves past it,
+* a query merges the live slices. Memory is Slices digests regardless of sample rate.
+*/
+template<size_t Slices, size_t Compression = 100>
+class WindowedDigest {
+public:
+    using Digest = TDigest<Compression>;
+
+    struct Summary {
+        float p5;
+        float p50;
+        float p95;
+        float min;
+        float max;
+        float count;
+    };
+
+    explicit WindowedDigest(uint32_t slice_ticks = 1) : m_slice_ticks(slice_ticks) {}
+
+    void setSliceTicks(uint32_t slice_ticks) {
+        m_slice_ticks = slice_ticks > 0 ? slice_ticks : 1;
+    }
+
+    void add(uint32_t tick, float value, float weight = 1.0f) {
+        advance(tick);
+        m_slices[m_current].add(value, weight);
+    }
+
+    /*
+    * @brief p5/p50/p95 and min/max over the window ending at `tick`.
+    */
+    Summary summarize(uint32_t tick) {
+        advance(tick);
+        Digest window;
+        for (const Digest& slice : m_slices) {
+            window.merge(slice);
+        }
+        return {
+            window.quantile(0.05f),
+            window.quantile(0.50f),
+            window.quantile(0.95f),
+            window.getMin(),
+            window.getMax(),
+            window.getCount()
+        };
+    }
+
+private:
+    /*
+    * @brief rotate slices forward to the one containing `tick`, clearing the ones that fell out of the window.
+    */
+    void advance(uint32_t tick) {
+        uint32_t slice_index = tick / m_slice_ticks;
+        if (!m_started) {
+            m_started = true;
+            m_slice_index = slice_index;
+            return;
+        }
+        uint32_t elapsed = slice_index - m_slice_index;
+        for (uint32_t i = 0; i < elapsed && i < Slices; i++) {
+            m_current = (m_current + 1) % Slices;
+            m_slices[m_current].reset();
+        }
+        m_slice_index = slice_index;
+    }
+
+    std::array<Digest, Slices> m_slices{};
+    size_t m_current = 0;
+    uint32_t m_slice_ticks;
+    uint32_t m_slice_index = 0;
+    bool m_started = false;
+};
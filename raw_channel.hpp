@@ -0,0 +1,342 @@
+#pragma once
+extern "C" {
+    #include "FreeRTOS.h"
+    #include "task.h"
+    #include "queue.h"
+}
+#include "sensor.hpp"
+#include "block_pool.hpp"
+#include <array>
+#include <cstdint>
+
+/*
+* @brief: Element carried on the raw path. Normally a single reading (count == 1, min == max == value),
+* under the COALESCE policy it can be the aggregate of several readings of one sensor, value then holds the mean.
+* enqueued is the tick the (first) reading entered the channel, used to measure queueing latency.
+* suppressed counts readings the sensor edge held back before this one because they were within its deadband.
+* fixed is the same reading in Q16.16 for the fixed point filter path (an aggregate's mean, rounded), so that path
+* never converts from float. Zero when the sender doesn't provide one.
+*/
+struct RawSample {
+    Sensor::Data data;
+    float min;
+    float max;
+    uint32_t count;
+    TickType_t enqueued;
+    uint32_t suppressed;
+    Q16_16 fixed;
+};
+
+// Shared by every raw channel. Worst case in use: every lane slot, one coalescing aggregate per lane and sensor,
+// one block being processed per shard and one being filled by the producer.
+static constexpr size_t RAW_POOL_BLOCKS = 128;
+using RawSamplePool = BlockPool<RawSample, RAW_POOL_BLOCKS>;
+
+/*
+* @brief: RawChannel carries samples from the sensor task to the processor task over one or more priority lanes.
+* Lane 0 is the most urgent. Each lane is its own FreeRTOS queue, all lanes are members of one queue set so the
+* processor sleeps on a single handle and then picks which lane to serve according to the drain policy:
+*   STRICT   - always serve the most urgent non-empty lane
+*   WEIGHTED - weighted round robin, lane i gets up to weights[i] samples per round while it has data
+*
+* The backpressure policy decides what happens when a lane is full, so a deployment can pick bounded sensor
+* latency over completeness:
+*   BLOCK       - wait for space, nothing is lost but a slow processor stalls polling (original behaviour)
+*   DROP_NEWEST - discard the sample that doesn't fit
+*   DROP_OLDEST - discard the oldest sample of that lane to make room
+*   COALESCE    - merge samples that don't fit into a per sensor min/max/mean aggregate. The consumer flushes aggregates
+*                 into the slot it just freed, so they don't wait for the sensor's next send.
+*
+* Samples live in a RawSamplePool, the lane queues only carry 16 bit handles. The producer fills a block in place,
+* the consumer reads it in place and hands it back with release(). If the pool runs dry the sample counts as dropped.
+*
+* Queue set bookkeeping: the set holds one entry per queued item. Anyone removing an item (consumer, or the producer
+* under DROP_OLDEST) first takes one entry from the set and then one item from whichever lane it likes, which keeps
+* entries and items equal without having to read the exact lane the set handed back.
+*
+* tools/bench_raw_lanes.cpp compares one FIFO against three lanes under a bulk flood, per policy and drain.
+*/
+class RawChannel {
+public:
+    enum class Policy { BLOCK, DROP_NEWEST, DROP_OLDEST, COALESCE };
+    enum class Drain { STRICT, WEIGHTED };
+    using Handle = RawSamplePool::Handle;
+
+    static constexpr size_t MAX_LANES = 3;
+
+    struct Stats {
+        uint32_t sent;
+        uint32_t dropped;
+        uint32_t merged;
+    };
+
+    /*
+    * @brief allocates the lane queues and the queue set, call before the scheduler starts.
+    * @param pool where samples are stored, may be shared between channels
+    * @param weights per lane share for the WEIGHTED drain policy, ignored for STRICT. NULL means all lanes weigh 1.
+    * @return false if any allocation failed
+    */
+    bool create(RawSamplePool* pool, UBaseType_t depth, Policy policy, size_t lanes = 1, Drain drain = Drain::STRICT, const uint8_t* weights = NULL) {
+        if (lanes == 0 || lanes > MAX_LANES) {
+            return false;
+        }
+        m_pool = pool;
+        m_policy = policy;
+        m_drain = drain;
+        m_lane_count = lanes;
+        m_set = xQueueCreateSet(depth * lanes);
+        if (m_set == NULL) {
+            return false;
+        }
+        for (size_t lane = 0; lane < lanes; lane++) {
+            m_lanes[lane] = xQueueCreate(depth, sizeof(Handle));
+            if (m_lanes[lane] == NULL || xQueueAddToSet(m_lanes[lane], m_set) != pdPASS) {
+                return false;
+            }
+            m_weights[lane] = (weights != NULL && weights[lane] > 0) ? weights[lane] : 1;
+            m_credits[lane] = m_weights[lane];
+        }
+        for (auto& lane_pending : m_pending) {
+            for (Pending& pending : lane_pending) {
+                pending.handle = RawSamplePool::INVALID_HANDLE;
+            }
+        }
+        return true;
+    }
+
+    /*
+    * @brief producer side, applies the configured policy when the lane is full.
+    * @param suppressed readings of this sensor held back at the edge since its previous send
+    * @param fixed the reading in Q16.16, carried for the fixed point filter path
+    * @return readings dropped by this call, this one or older ones pushed out under DROP_OLDEST
+    */
+    uint32_t send(const Sensor::Data& data, size_t lane = 0, uint32_t suppressed = 0, Q16_16 fixed = Q16_16()) {
+        const uint32_t dropped_before = m_stats.dropped;
+        if (lane >= m_lane_count) {
+            lane = m_lane_count - 1;
+        }
+        if (m_policy == Policy::COALESCE) {
+            coalesce(data, lane, suppressed, fixed);
+            return m_stats.dropped - dropped_before;
+        }
+
+        Handle handle = fill(data, suppressed, fixed);
+        if (handle == RawSamplePool::INVALID_HANDLE) {
+            m_stats.dropped++;
+            return m_stats.dropped - dropped_before;
+        }
+        QueueHandle_t queue = m_lanes[lane];
+
+        switch (m_policy) {
+        case Policy::BLOCK:
+            xQueueSend(queue, &handle, portMAX_DELAY);
+            m_stats.sent++;
+            break;
+        case Policy::DROP_NEWEST:
+            if (xQueueSend(queue, &handle, 0) == pdPASS) {
+                m_stats.sent++;
+            }
+            else {
+                m_pool->release(handle);
+                m_stats.dropped++;
+            }
+            break;
+        case Policy::DROP_OLDEST:
+            if (xQueueSend(queue, &handle, 0) != pdPASS) {
+                Handle discarded;
+                if (xQueueSelectFromSet(m_set, 0) != NULL && xQueueReceive(queue, &discarded, 0) == pdPASS) {
+                    m_stats.dropped += m_pool->get(discarded).count;
+                    m_pool->release(discarded);
+                }
+                if (xQueueSend(queue, &handle, 0) != pdPASS) {
+                    m_pool->release(handle);
+                    m_stats.dropped++;
+                    break;
+                }
+            }
+            m_stats.sent++;
+            break;
+        default:
+            break;
+        }
+        return m_stats.dropped - dropped_before;
+    }
+
+    /*
+    * @brief consumer side, wait up to `timeout` for the next sample and pick its lane by the drain policy.
+    * The sample is read in place through get() and must be handed back with release().
+    * @param lane_out set to the lane the sample came from
+    */
+    bool receive(Handle& out, TickType_t timeout, size_t* lane_out = NULL) {
+        if (xQueueSelectFromSet(m_set, timeout) == NULL) {
+            return false;
+        }
+        // An item is reserved for us now, only a concurrent DROP_OLDEST can empty the lane we look at, so retry
+        while (1) {
+            size_t lane = pickLane();
+            if (xQueueReceive(m_lanes[lane], &out, 0) == pdPASS) {
+                if (lane_out != NULL) {
+                    *lane_out = lane;
+                }
+                if (m_policy == Policy::COALESCE) {
+                    // the aggregates belong to the producer, keep it off them while they move into the freed slot
+                    vTaskSuspendAll();
+                    flushPending();
+                    xTaskResumeAll();
+                }
+                return true;
+            }
+        }
+    }
+
+    const RawSample& get(Handle handle) const {
+        return m_pool->get(handle);
+    }
+
+    void release(Handle handle) {
+        m_pool->release(handle);
+    }
+
+    Stats stats() const {
+        return m_stats;
+    }
+
+    Policy policy() const {
+        return m_policy;
+    }
+
+    size_t laneCount() const {
+        return m_lane_count;
+    }
+
+    UBaseType_t waiting(size_t lane) const {
+        return uxQueueMessagesWaiting(m_lanes[lane]);
+    }
+
+private:
+    size_t pickLane() {
+        if (m_drain == Drain::STRICT) {
+            for (size_t lane = 0; lane < m_lane_count; lane++) {
+                if (uxQueueMessagesWaiting(m_lanes[lane]) > 0) {
+                    return lane;
+                }
+            }
+            return 0;
+        }
+
+        // WEIGHTED: most urgent lane that still has credit this round, refill once every busy lane has spent its share
+        for (int pass = 0; pass < 2; pass++) {
+            for (size_t lane = 0; lane < m_lane_count; lane++) {
+                if (m_credits[lane] > 0 && uxQueueMessagesWaiting(m_lanes[lane]) > 0) {
+                    m_credits[lane]--;
+                    return lane;
+                }
+            }
+            m_credits = m_weights;
+        }
+        return 0;
+    }
+
+    /*
+    * @brief acquire a pool block and fill it with a single reading.
+    */
+    Handle fill(const Sensor::Data& data, uint32_t suppressed, Q16_16 fixed) {
+        Handle handle = m_pool->acquire();
+        if (handle != RawSamplePool::INVALID_HANDLE) {
+            m_pool->get(handle) = { data, data.value, data.value, 1, xTaskGetTickCount(), suppressed, fixed };
+        }
+        return handle;
+    }
+
+    /*
+    * @brief COALESCE send, suspends the scheduler around the aggregates since the consumer flushes them as well.
+    */
+    void coalesce(const Sensor::Data& data, size_t lane, uint32_t suppressed, Q16_16 fixed) {
+        vTaskSuspendAll();
+        coalesceLocked(data, lane, suppressed, fixed);
+        xTaskResumeAll();
+    }
+
+    void coalesceLocked(const Sensor::Data& data, size_t lane, uint32_t suppressed, Q16_16 fixed) {
+        flushPending();
+
+        Pending& pending = m_pending[lane][static_cast<size_t>(data.type)];
+        if (pending.handle != RawSamplePool::INVALID_HANDLE) {
+            // Already behind for this sensor, fold in to keep the sensor's samples in order
+            merge(pending, data, suppressed, fixed);
+            m_stats.merged++;
+            return;
+        }
+        Handle handle = fill(data, suppressed, fixed);
+        if (handle == RawSamplePool::INVALID_HANDLE) {
+            m_stats.dropped++;
+            return;
+        }
+        if (xQueueSend(m_lanes[lane], &handle, 0) == pdPASS) {
+            m_stats.sent++;
+            return;
+        }
+        // Lane full, the block stays with the producer and becomes the aggregate
+        pending.handle = handle;
+        pending.sum = data.value;
+        pending.fixed_sum = fixed.raw();
+    }
+
+    /*
+    * @brief push any waiting aggregates now that the processor may have caught up. Scheduler suspended.
+    */
+    void flushPending() {
+        for (size_t lane = 0; lane < m_lane_count; lane++) {
+            flushLane(lane);
+        }
+    }
+
+    void flushLane(size_t lane) {
+        for (Pending& pending : m_pending[lane]) {
+            if (pending.handle == RawSamplePool::INVALID_HANDLE) {
+                continue;
+            }
+            RawSample& agg = m_pool->get(pending.handle);
+            agg.data.value = pending.sum / static_cast<float>(agg.count);
+            agg.fixed = Q16_16::fromRaw(static_cast<int32_t>(roundingMean(pending.fixed_sum, agg.count)));
+            if (xQueueSend(m_lanes[lane], &pending.handle, 0) != pdPASS) {
+                return; // lane still full, this and the lane's other aggregates keep aggregating
+            }
+            m_stats.sent++;
+            pending.handle = RawSamplePool::INVALID_HANDLE;
+        }
+    }
+
+    struct Pending {
+        Handle handle; // block being aggregated into, touched with the scheduler suspended until it is sent
+        float sum;     // kept separately from the mean so repeated merges don't accumulate rounding
+        int64_t fixed_sum;
+    };
+
+    static int64_t roundingMean(int64_t sum, uint32_t count) {
+        const int64_t half = count / 2;
+        return sum >= 0 ? (sum + half) / count : -((-sum + half) / count);
+    }
+
+    void merge(Pending& pending, const Sensor::Data& data, uint32_t suppressed, Q16_16 fixed) {
+        RawSample& agg = m_pool->get(pending.handle);
+        pending.sum += data.value;
+        pending.fixed_sum += fixed.raw();
+        agg.min = min(agg.min, data.value);
+        agg.max = max(agg.max, data.value);
+        agg.data.timestamp = data.timestamp; // aggregate is stamped with its newest reading, enqueued keeps the oldest
+        agg.count++;
+        agg.suppressed += suppressed;
+    }
+
+    RawSamplePool* m_pool = NULL;
+    std::array<QueueHandle_t, MAX_LANES> m_lanes{};
+    QueueSetHandle_t m_set = NULL;
+    size_t m_lane_count = 0;
+    Policy m_policy = Policy::BLOCK;
+    Drain m_drain = Drain::STRICT;
+    std::array<uint8_t, MAX_LANES> m_weights{};
+    std::array<uint8_t, MAX_LANES> m_credits{};
+    Stats m_stats = { 0, 0, 0 };
+    std::array<std::array<Pending, Sensor::TYPE_COUNT>, MAX_LANES> m_pending{};
+};
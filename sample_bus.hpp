@@ -0,0 +1,145 @@
+#pragma once
+extern "C" {
+    #include "FreeRTOS.h"
+    #include "queue.h"
+}
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+* @brief: Default ownership policy for SampleBus, samples are plain values copied into every subscriber queue.
+*/
+template<typename T>
+struct CopyOwnership {
+    void retain(const T&) {}
+    void release(const T&) {}
+};
+
+/*
+* @brief: SampleBus is a fan-out publish/subscribe bus. Every subscriber owns a bounded FreeRTOS queue and an overflow policy,
+* the publisher only ever does zero timeout queue operations so a slow or stalled subscriber can never block it.
+* Subscribers must be registered before the scheduler starts, the subscriber table is not guarded after that.
+* publish() may be called from several tasks at once (one per processor shard), the counters are atomic for that reason.
+* The Ownership policy is told about every copy that lands in or leaves a subscriber queue, which lets T be a handle to
+* a shared, reference counted block (see BlockPool::Ownership) instead of the sample itself.
+*/
+template<typename T, size_t MaxSubscribers, typename Ownership = CopyOwnership<T>>
+class SampleBus {
+public:
+    enum class OverflowPolicy { DROP_NEWEST, DROP_OLDEST };
+
+    using Handle = int;
+    static constexpr Handle INVALID_HANDLE = -1;
+
+    struct Stats {
+        const char* name;
+        uint32_t delivered;
+        uint32_t dropped;
+        UBaseType_t lag;      // samples currently waiting for the subscriber, read when stats() is called
+        UBaseType_t max_lag;  // high-water mark of lag
+    };
+
+    explicit SampleBus(Ownership ownership = Ownership()) : m_ownership(ownership) {}
+
+    /*
+    * @brief register a subscriber with its own buffer of `depth` samples.
+    * @return handle used for receive() and stats(), INVALID_HANDLE if the table is full or the queue can't be allocated.
+    */
+    Handle subscribe(const char* name, UBaseType_t depth, OverflowPolicy policy) {
+        if (m_count >= MaxSubscribers) {
+            return INVALID_HANDLE;
+        }
+        QueueHandle_t queue = xQueueCreate(depth, sizeof(T));
+        if (queue == NULL) {
+            return INVALID_HANDLE;
+        }
+        Subscriber& sub = m_subscribers[m_count];
+        sub.queue = queue;
+        sub.policy = policy;
+        sub.name = name;
+        return static_cast<Handle>(m_count++);
+    }
+
+    /*
+    * @brief deliver a sample to every subscriber, never blocks. Each subscriber that receives it owns one reference
+    * and hands it back with release() once done, the publisher keeps its own reference.
+    */
+    void publish(const T& sample) {
+        for (size_t i = 0; i < m_count; i++) {
+            Subscriber& sub = m_subscribers[i];
+            m_ownership.retain(sample);
+            if (xQueueSend(sub.queue, &sample, 0) == pdPASS) {
+                sub.delivered.fetch_add(1, std::memory_order_relaxed);
+            }
+            else if (sub.policy == OverflowPolicy::DROP_OLDEST) {
+                T discarded;
+                if (xQueueReceive(sub.queue, &discarded, 0) == pdPASS) { // make room, subscriber loses its oldest sample
+                    m_ownership.release(discarded);
+                }
+                sub.dropped.fetch_add(1, std::memory_order_relaxed);
+                if (xQueueSend(sub.queue, &sample, 0) == pdPASS) {
+                    sub.delivered.fetch_add(1, std::memory_order_relaxed);
+                }
+                else {
+                    m_ownership.release(sample);
+                    sub.dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            else {
+                m_ownership.release(sample);
+                sub.dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            UBaseType_t lag = uxQueueMessagesWaiting(sub.queue);
+            UBaseType_t max_lag = sub.max_lag.load(std::memory_order_relaxed);
+            while (lag > max_lag && !sub.max_lag.compare_exchange_weak(max_lag, lag, std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+    /*
+    * @brief subscriber side, wait up to `timeout` for the next sample.
+    */
+    bool receive(Handle handle, T& out, TickType_t timeout) {
+        return xQueueReceive(m_subscribers[handle].queue, &out, timeout) == pdPASS;
+    }
+
+    /*
+    * @brief subscriber side, hand back a sample obtained from receive().
+    */
+    void release(const T& sample) {
+        m_ownership.release(sample);
+    }
+
+    /*
+    * @return counters for one subscriber, lag is refreshed on each call.
+    */
+    Stats stats(Handle handle) const {
+        const Subscriber& sub = m_subscribers[handle];
+        return {
+            sub.name,
+            sub.delivered.load(std::memory_order_relaxed),
+            sub.dropped.load(std::memory_order_relaxed),
+            uxQueueMessagesWaiting(sub.queue),
+            sub.max_lag.load(std::memory_order_relaxed)
+        };
+    }
+
+    size_t subscriberCount() const {
+        return m_count;
+    }
+
+private:
+    struct Subscriber {
+        QueueHandle_t queue = NULL;
+        OverflowPolicy policy = OverflowPolicy::DROP_NEWEST;
+        const char* name = "";
+        std::atomic<uint32_t> delivered{ 0 };
+        std::atomic<uint32_t> dropped{ 0 };
+        std::atomic<UBaseType_t> max_lag{ 0 };
+    };
+
+    std::array<Subscriber, MaxSubscribers> m_subscribers;
+    Ownership m_ownership;
+    size_t m_count = 0;
+};
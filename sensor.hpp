@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include "fixed_point.hpp"
 
 /*
 * @brief: The Sensor class is the base class for all mock sensors, it provides the structure for sensor Data.
@@ -10,6 +11,7 @@
 class Sensor {
 public:
     enum class Type { TEMPERATURE, LIGHT, HUMIDITY };
+    static constexpr size_t TYPE_COUNT = 3; // keep in sync with Type, used to size per sensor tables
 
     struct Data {
         float value;
@@ -17,6 +19,22 @@ public:
         uint64_t timestamp;
     };
 
+    // Fixed point reading for FPU-less targets, same layout as Data with a Q16.16 value
+    struct FixedData {
+        Q16_16 value;
+        Type type;
+        uint64_t timestamp;
+    };
+
+    static const char* typeName(Type type) {
+        switch (type) {
+        case Type::TEMPERATURE: return "Temperature";
+        case Type::LIGHT:       return "Light";
+        case Type::HUMIDITY:    return "Humidity";
+        default:                return "Unknown";
+        }
+    }
+
     Type getType() const {
         return m_type;
     }
@@ -25,6 +43,15 @@ public:
     virtual ~Sensor() = default;
     virtual Data read() const = 0;
 
+    /*
+    * @brief fixed point variant of read(), one reading either way. The default converts the float reading for sensors
+    * registered at runtime, drivers on FPU-less targets and the mock sensors override it without touching float.
+    */
+    virtual FixedData readFixed() const {
+        Data data = read();
+        return { Q16_16::fromFloat(data.value), data.type, data.timestamp };
+    }
+
 protected:
     Type m_type;
     mutable uint32_t m_counter = 0;
@@ -0,0 +1,212 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/*
+* @brief: SensorBus simulates the timing of sensors sharing one I2C/SPI style bus, so the polling loop can be written
+* the way real drivers work: start a conversion, let the device convert on its own, read the result once it is ready.
+* Only time is modelled, the caller gets complete() callbacks with device indices and fetches the readings itself.
+*   conversion - per device, runs in the device and occupies nothing
+*   transaction - occupies the bus for transaction_us plus byte_us per byte, transactions never overlap
+*   batching - up to max_batch devices share one transaction (combined repeated start / DMA chain), paying
+*              the transaction overhead once. max_batch = 1 gives one transaction per device.
+* In BLOCKING mode a device is started only after the previous one was read, the way a driver with a blocking
+* read() serialises the bus. In OVERLAPPED mode every device is started at the beginning of the cycle and results
+* are collected as they become ready, so conversions overlap and a cycle costs the slowest conversion plus bus time.
+* Times are microseconds from any monotonic source. Single task only, stats are read best effort.
+* tools/bench_sensor_bus.cpp measures the cycle time of each mode for 3 and 100 devices.
+*/
+template<size_t MaxDevices = 128>
+class SensorBus {
+public:
+    enum class Mode { BLOCKING, OVERLAPPED };
+
+    struct Timing {
+        uint32_t transaction_us; // start condition, turnaround and stop
+        uint32_t byte_us;        // per byte including ack, ~23 us at 400 kHz I2C
+        uint32_t max_batch;      // devices per combined transaction
+    };
+
+    struct Stats {
+        size_t devices;
+        uint32_t cycles;
+        uint32_t transactions;   // all cycles
+        uint64_t last_cycle_us;  // cycle start until the last result was read
+        uint64_t max_cycle_us;
+        uint64_t total_cycle_us;
+        uint64_t busy_us;        // bus occupied, all cycles
+    };
+
+    static constexpr uint64_t NEVER = UINT64_MAX;
+
+    void configure(Mode mode, const Timing& timing) {
+        m_mode = mode;
+        m_timing = timing;
+        if (m_timing.max_batch == 0) {
+            m_timing.max_batch = 1;
+        }
+    }
+
+    /*
+    * @brief add a device, its index is the number of devices attached before it. Call before the first cycle.
+    * @param read_bytes bytes of one result, not counting the address
+    * @return false if MaxDevices are attached already
+    */
+    bool attach(uint32_t conversion_us, uint8_t read_bytes) {
+        if (m_count >= MaxDevices) {
+            return false;
+        }
+        m_devices[m_count++] = { conversion_us, read_bytes, State::IDLE, 0 };
+        return true;
+    }
+
+    void startCycle(uint64_t now) {
+        m_cycle_start = now;
+        if (m_bus_free < now) {
+            m_bus_free = now;
+        }
+        m_remaining = m_count;
+        m_next_start = 0;
+        if (m_count == 0) {
+            return;
+        }
+        startDevices(m_mode == Mode::OVERLAPPED ? m_count : 1);
+    }
+
+    bool cycleDone() const {
+        return m_remaining == 0;
+    }
+
+    /*
+    * @return when the earliest running conversion finishes, NEVER if none is running
+    */
+    uint64_t nextEvent() const {
+        uint64_t next = NEVER;
+        for (size_t i = 0; i < m_count; i++) {
+            if (m_devices[i].state == State::CONVERTING && m_devices[i].ready_at < next) {
+                next = m_devices[i].ready_at;
+            }
+        }
+        return next;
+    }
+
+    /*
+    * @brief read out devices whose conversion finished by `now`, one batched transaction per max_batch devices,
+    * calling f(device index, read_at) for each once its transaction is over. read_at is when the result is off the
+    * bus, the transactions are queued behind whatever is still on it so it can lie after `now`.
+    * @return number of devices read
+    */
+    template<typename F>
+    size_t complete(uint64_t now, F&& f) {
+        size_t read = 0;
+        size_t batch = 0;
+        size_t batch_first = 0;
+        uint32_t bytes = 0;
+        for (size_t i = 0; i < m_count; i++) {
+            Device& device = m_devices[i];
+            if (device.state != State::CONVERTING || device.ready_at > now) {
+                continue;
+            }
+            device.state = State::READING;
+            if (batch == 0) {
+                batch_first = i;
+            }
+            bytes += 1 + device.read_bytes;
+            read++;
+            if (++batch == m_timing.max_batch) {
+                deliver(batch_first, i + 1, transaction(now, bytes), f);
+                batch = 0;
+                bytes = 0;
+            }
+        }
+        if (batch > 0) {
+            deliver(batch_first, m_count, transaction(now, bytes), f);
+        }
+        m_remaining -= read;
+        if (read > 0 && m_mode == Mode::BLOCKING && m_next_start < m_count) {
+            startDevices(1);
+        }
+        if (read > 0 && m_remaining == 0) {
+            uint64_t cycle = m_bus_free - m_cycle_start;
+            m_stats.cycles++;
+            m_stats.last_cycle_us = cycle;
+            m_stats.total_cycle_us += cycle;
+            if (cycle > m_stats.max_cycle_us) {
+                m_stats.max_cycle_us = cycle;
+            }
+        }
+        return read;
+    }
+
+    Mode mode() const {
+        return m_mode;
+    }
+
+    Stats stats() const {
+        Stats stats = m_stats;
+        stats.devices = m_count;
+        return stats;
+    }
+
+private:
+    enum class State : uint8_t { IDLE, CONVERTING, READING };
+
+    struct Device {
+        uint32_t conversion_us;
+        uint8_t read_bytes;
+        State state;
+        uint64_t ready_at;
+    };
+
+    /*
+    * @brief start the next `count` devices, an address and a command byte each, batched like reads.
+    */
+    void startDevices(size_t count) {
+        const size_t end = m_next_start + count;
+        while (m_next_start < end) {
+            const size_t first = m_next_start;
+            const size_t batch_end = first + m_timing.max_batch < end ? first + m_timing.max_batch : end;
+            const uint64_t done = transaction(m_bus_free, static_cast<uint32_t>(2 * (batch_end - first)));
+            for (size_t i = first; i < batch_end; i++) {
+                m_devices[i].state = State::CONVERTING;
+                m_devices[i].ready_at = done + m_devices[i].conversion_us;
+            }
+            m_next_start = batch_end;
+        }
+    }
+
+    /*
+    * @brief hand the devices of one finished read transaction in [first, end) to the caller.
+    */
+    template<typename F>
+    void deliver(size_t first, size_t end, uint64_t read_at, F& f) {
+        for (size_t i = first; i < end; i++) {
+            if (m_devices[i].state == State::READING) {
+                m_devices[i].state = State::IDLE;
+                f(i, read_at);
+            }
+        }
+    }
+
+    /*
+    * @return when the transaction finishes
+    */
+    uint64_t transaction(uint64_t now, uint32_t bytes) {
+        const uint64_t duration = m_timing.transaction_us + static_cast<uint64_t>(bytes) * m_timing.byte_us;
+        m_bus_free = (m_bus_free > now ? m_bus_free : now) + duration;
+        m_stats.transactions++;
+        m_stats.busy_us += duration;
+        return m_bus_free;
+    }
+
+    Mode m_mode = Mode::OVERLAPPED;
+    Timing m_timing = { 25, 23, 1 };
+    std::array<Device, MaxDevices> m_devices{};
+    size_t m_count = 0;
+    size_t m_remaining = 0;
+    size_t m_next_start = 0;
+    uint64_t m_cycle_start = 0;
+    uint64_t m_bus_free = 0;
+    Stats m_stats = {};
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include "sensor.hpp"
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+/*
+* @brief: SensorSet is a compile-time collection of concrete sensors held in a std::tuple.
+* Reads go straight to the concrete (final) read(), so there is no vtable lookup and the compiler can inline
+* the mock sensors' math into the polling loop. Sensors only known at runtime keep using the virtual Sensor interface.
+* With the mock sensors the saving is small next to their rand() and sin(), tools/bench_sensor_dispatch.cpp times both.
+*/
+template<typename... Sensors>
+class SensorSet {
+public:
+    static_assert((std::is_base_of_v<Sensor, Sensors> && ...), "SensorSet members must derive from Sensor");
+
+    static constexpr size_t SIZE = sizeof...(Sensors);
+
+    /*
+    * @brief read only the sensor at `idx`, used for round robin polling. Dispatch is a chain of compares
+    * the compiler can turn into a jump table, still no vtable.
+    * @return false if idx is out of range
+    */
+    template<typename F>
+    bool readAt(size_t idx, F&& f) const {
+        return readAt(idx, f, std::index_sequence_for<Sensors...>{});
+    }
+
+    /*
+    * @brief readAt() for the fixed point path, f gets the sensor's readFixed() instead.
+    */
+    template<typename F>
+    bool readFixedAt(size_t idx, F&& f) const {
+        return readFixedAt(idx, f, std::index_sequence_for<Sensors...>{});
+    }
+
+    template<typename S>
+    S& get() {
+        return std::get<S>(m_sensors);
+    }
+
+private:
+    template<typename F, size_t... Is>
+    bool readAt(size_t idx, F& f, std::index_sequence<Is...>) const {
+        return ((idx == Is ? (f(std::get<Is>(m_sensors).read()), true) : false) || ...);
+    }
+
+    template<typename F, size_t... Is>
+    bool readFixedAt(size_t idx, F& f, std::index_sequence<Is...>) const {
+        return ((idx == Is ? (f(std::get<Is>(m_sensors).readFixed()), true) : false) || ...);
+    }
+
+    std::tuple<Sensors...> m_sensors;
+};
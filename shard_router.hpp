@@ -0,0 +1,132 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+* @brief: ShardRouter maps keys (sensor IDs) onto K processor shards. Each key has exactly one owning shard at a time,
+* so per key state (filters) is only ever touched by one task and needs no locks.
+*
+* Keys start out hash partitioned. With rebalancing enabled, ownership can migrate from the busiest to the idlest shard
+* ("work stealing" at key granularity). A key only moves while its current owner has nothing in flight, i.e. every reading
+* routed to it has been completed or discarded. Accounting is per reading, not per queued item: a block that carries a
+* coalesced aggregate completes all the readings merged into it, readings the channel dropped are handed back with discarded(). The queue hop to the new owner then orders the old owner's last state update before
+* the new owner's first read.
+*
+* route(), discarded() and rebalance() must only be called from the single producer, completed() from the shard that
+* processed the readings.
+*/
+template<size_t MaxShards, size_t Keys>
+class ShardRouter {
+public:
+    void init(size_t shards) {
+        m_shards = (shards == 0 || shards > MaxShards) ? MaxShards : shards;
+        for (size_t key = 0; key < Keys; key++) {
+            m_owner[key] = hash(key) % m_shards;
+        }
+    }
+
+    /*
+    * @brief producer side, pick the shard for a sample of `key` and account for it.
+    */
+    size_t route(size_t key) {
+        size_t shard = m_owner[key];
+        m_routed[shard]++;
+        m_window[key]++;
+        return shard;
+    }
+
+    /*
+    * @brief shard side, `readings` routed to `shard` have been fully processed.
+    */
+    void completed(size_t shard, uint32_t readings = 1) {
+        m_completed[shard].fetch_add(readings, std::memory_order_release);
+    }
+
+    /*
+    * @brief producer side, `readings` routed to `shard` were dropped on the way and will never be completed.
+    */
+    void discarded(size_t shard, uint32_t readings) {
+        m_routed[shard] -= readings;
+    }
+
+    /*
+    * @brief producer side, call once per load window. Moves one key from the busiest to the idlest shard if that narrows the gap.
+    * @return true if a key migrated
+    */
+    bool rebalance() {
+        std::array<uint32_t, MaxShards> load{};
+        for (size_t key = 0; key < Keys; key++) {
+            load[m_owner[key]] += m_window[key];
+        }
+        size_t busiest = 0;
+        size_t idlest = 0;
+        for (size_t shard = 1; shard < m_shards; shard++) {
+            if (load[shard] > load[busiest]) {
+                busiest = shard;
+            }
+            if (load[shard] < load[idlest]) {
+                idlest = shard;
+            }
+        }
+
+        bool moved = false;
+        uint32_t gap = load[busiest] - load[idlest];
+        if (busiest != idlest && idle(busiest)) {
+            // Moving a key of weight w turns the gap into |gap - 2w|, pick the key that gets closest to even
+            size_t candidate = Keys;
+            uint32_t best_gap = gap;
+            for (size_t key = 0; key < Keys; key++) {
+                uint32_t w = m_window[key];
+                if (m_owner[key] != busiest || w == 0 || w >= gap) {
+                    continue;
+                }
+                uint32_t new_gap = 2 * w > gap ? 2 * w - gap : gap - 2 * w;
+                if (new_gap < best_gap) {
+                    best_gap = new_gap;
+                    candidate = key;
+                }
+            }
+            if (candidate != Keys) {
+                m_owner[candidate] = idlest;
+                m_migrations++;
+                moved = true;
+            }
+        }
+        m_window.fill(0);
+        return moved;
+    }
+
+    size_t owner(size_t key) const {
+        return m_owner[key];
+    }
+
+    size_t shardCount() const {
+        return m_shards;
+    }
+
+    uint32_t completedCount(size_t shard) const {
+        return m_completed[shard].load(std::memory_order_relaxed);
+    }
+
+    uint32_t migrations() const {
+        return m_migrations;
+    }
+
+private:
+    bool idle(size_t shard) const {
+        return m_completed[shard].load(std::memory_order_acquire) == m_routed[shard];
+    }
+
+    static size_t hash(size_t key) {
+        // Knuth multiplicative hash, spreads sequential IDs across shards
+        return static_cast<size_t>((static_cast<uint32_t>(key) * 2654435761u) >> 16);
+    }
+
+    size_t m_shards = 1;
+    std::array<size_t, Keys> m_owner{};
+    std::array<uint32_t, Keys> m_window{};          // samples per key in the current load window
+    std::array<uint32_t, MaxShards> m_routed{};     // readings still expected to complete, producer owned
+    std::array<std::atomic<uint32_t>, MaxShards> m_completed{};
+    uint32_t m_migrations = 0;
+};
@@ -0,0 +1,486 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include "host_socket.hpp"
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <signal.h>
+#endif
+
+/*
+* @brief: SnapshotServer serves a fixed set of documents over HTTP/1.1 to local clients without any per request work on
+* the producer's side. The producer renders every document once per data update into a spare slot and publishes the
+* slot with one atomic store. The status line and headers are put in front of each body at publish time, so a request
+* is answered by sending a byte range of the current slot.
+* A connection pins the slot it is sending from, and the producer only renders into unpinned slots, so a slow client
+* never holds up a publish and never sees a half written document. If every spare slot is pinned the update is
+* skipped and counted, the next one gets through.
+* The server runs in a host thread of its own, not an RTOS task, and never calls the kernel. It has one poll() loop over
+* non-blocking sockets (WSAPoll() on Windows) and supports keep-alive and pipelined GETs, closing connections idle for
+* IDLE_TIMEOUT.
+*/
+template<size_t Documents, size_t Capacity = 16384, size_t Slots = 4, size_t MaxClients = 512>
+class SnapshotServer {
+public:
+    static_assert(Slots >= 2, "the producer needs a slot besides the published one");
+
+    struct Route {
+        const char* path;
+        const char* content_type;
+    };
+
+    struct Stats {
+        uint32_t published;
+        uint32_t skipped;    // every spare slot was pinned
+        uint32_t overflows;  // a document outgrew Capacity and answers 503 until the next publish
+        uint32_t clients;    // connected now
+        uint32_t rejected;   // MaxClients were connected already
+        uint64_t requests;
+        uint64_t bytes;
+    };
+
+    ~SnapshotServer() {
+        stop();
+    }
+
+    /*
+    * @brief listen on 127.0.0.1:port and start the server thread. Requests get 503 until the first publish.
+    * @param routes request path of each document, the array is referenced, not copied
+    * @return false if the port couldn't be bound
+    */
+    bool start(uint16_t port, const Route (&routes)[Documents]) {
+        if (!host_socket::startup()) {
+            return false;
+        }
+        m_routes = routes;
+        m_listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_listener == host_socket::INVALID) {
+            return false;
+        }
+        host_socket::reuseAddress(m_listener);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(m_listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(m_listener, SOMAXCONN) != 0 ||
+            !host_socket::setNonBlocking(m_listener)) {
+            host_socket::close(m_listener);
+            m_listener = host_socket::INVALID;
+            return false;
+        }
+        for (Client& client : m_clients) {
+            client.fd = host_socket::INVALID;
+        }
+        m_running = true;
+#if !defined(_WIN32)
+        // The thread inherits a mask with every signal blocked, so the POSIX port's tick and suspend signals are never
+        // delivered to a thread the scheduler doesn't know about
+        sigset_t all;
+        sigset_t previous;
+        sigfillset(&all);
+        pthread_sigmask(SIG_BLOCK, &all, &previous);
+        m_thread = std::thread([this] { run(); });
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+#else
+        m_thread = std::thread([this] { run(); });
+#endif
+        return true;
+    }
+
+    void stop() {
+        m_running = false;
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        if (m_listener != host_socket::INVALID) {
+            host_socket::close(m_listener);
+            m_listener = host_socket::INVALID;
+        }
+    }
+
+    /*
+    * @brief pick a slot to render the next update into. Producer side, a single task.
+    * @return false if every spare slot is pinned, skip this update
+    */
+    bool begin() {
+        const int current = m_current.load();
+        for (size_t i = 0; i < Slots; i++) {
+            if (static_cast<int>(i) != current && m_slots[i].pins.load() == 0) {
+                m_writing = static_cast<int>(i);
+                for (size_t document = 0; document < Documents; document++) {
+                    m_slots[i].body_length[document] = 0;
+                    m_slots[i].overflow[document] = false;
+                }
+                return true;
+            }
+        }
+        m_skipped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /*
+    * @brief snprintf onto the end of a document in the slot begin() picked.
+    */
+    template<typename... Args>
+    void append(size_t document, const char* format, Args... args) {
+        Slot& slot = m_slots[m_writing];
+        if (slot.overflow[document]) {
+            return;
+        }
+        size_t& length = slot.body_length[document];
+        char* end = slot.data[document] + HEADER_RESERVE + length;
+        const size_t room = Capacity - HEADER_RESERVE - length;
+        int written;
+        if constexpr (sizeof...(Args) == 0) {
+            written = snprintf(end, room, "%s", format);
+        }
+        else {
+            written = snprintf(end, room, format, args...);
+        }
+        if (written < 0 || static_cast<size_t>(written) >= room) {
+            slot.overflow[document] = true;
+            return;
+        }
+        length += static_cast<size_t>(written);
+    }
+
+    /*
+    * @brief put the status line and headers in front of every document, then make the slot the one served.
+    */
+    void publish() {
+        Slot& slot = m_slots[m_writing];
+        for (size_t document = 0; document < Documents; document++) {
+            if (slot.overflow[document]) {
+                m_overflows.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            char header[HEADER_RESERVE];
+            int length = snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %lu\r\n"
+                "Cache-Control: no-store\r\n\r\n", m_routes[document].content_type, (unsigned long)slot.body_length[document]);
+            if (length < 0 || static_cast<size_t>(length) >= sizeof(header)) {
+                slot.overflow[document] = true;
+                continue;
+            }
+            slot.response[document] = slot.data[document] + HEADER_RESERVE - length;
+            memcpy(slot.response[document], header, static_cast<size_t>(length));
+            slot.response_length[document] = static_cast<size_t>(length) + slot.body_length[document];
+        }
+        m_current.store(m_writing);
+        m_writing = -1;
+        m_published.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Stats stats() const {
+        return { m_published.load(std::memory_order_relaxed), m_skipped.load(std::memory_order_relaxed),
+            m_overflows.load(std::memory_order_relaxed), m_client_count.load(std::memory_order_relaxed),
+            m_rejected.load(std::memory_order_relaxed), m_requests.load(std::memory_order_relaxed),
+            m_bytes.load(std::memory_order_relaxed) };
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t HEADER_RESERVE = 192;
+    static constexpr size_t REQUEST_CAPACITY = 1024;
+    static constexpr int POLL_TIMEOUT_MS = 250;
+    static constexpr auto IDLE_TIMEOUT = std::chrono::seconds(30);
+
+    static_assert(Capacity > HEADER_RESERVE, "Capacity must leave room for a body");
+
+    struct Slot {
+        std::atomic<uint32_t> pins{ 0 };
+        size_t body_length[Documents];
+        bool overflow[Documents];
+        char* response[Documents];
+        size_t response_length[Documents];
+        char data[Documents][Capacity];
+    };
+
+    struct Client {
+        host_socket::Handle fd;  // INVALID while the entry is free
+        char request[REQUEST_CAPACITY];
+        size_t request_length;
+        int slot;                // pinned while a document is being sent, -1 otherwise
+        const char* pending;     // rest of the response
+        size_t remaining;
+        bool close_after;
+        Clock::time_point last_active;
+    };
+
+    void run() {
+        std::array<host_socket::PollFd, MaxClients + 1>& fds = m_fds;
+        std::array<size_t, MaxClients + 1>& owners = m_owners;
+        while (m_running.load(std::memory_order_relaxed)) {
+            size_t count = 0;
+            fds[count++] = { m_listener, POLLIN, 0 };
+            for (size_t i = 0; i < MaxClients; i++) {
+                if (m_clients[i].fd != host_socket::INVALID) {
+                    owners[count] = i;
+                    fds[count++] = { m_clients[i].fd, static_cast<short>(m_clients[i].remaining > 0 ? POLLOUT : POLLIN), 0 };
+                }
+            }
+            if (host_socket::poll(fds.data(), count, POLL_TIMEOUT_MS) < 0 && !host_socket::interrupted()) {
+                break;
+            }
+            const Clock::time_point now = Clock::now();
+            for (size_t i = 1; i < count; i++) {
+                if (fds[i].revents != 0) {
+                    service(m_clients[owners[i]], now);
+                }
+            }
+            if ((fds[0].revents & POLLIN) != 0) {
+                acceptClients(now);
+            }
+            for (Client& client : m_clients) {
+                if (client.fd != host_socket::INVALID && now - client.last_active > IDLE_TIMEOUT) {
+                    closeClient(client);
+                }
+            }
+        }
+        for (Client& client : m_clients) {
+            if (client.fd != host_socket::INVALID) {
+                closeClient(client);
+            }
+        }
+    }
+
+    void acceptClients(Clock::time_point now) {
+        while (1) {
+            host_socket::Handle fd = accept(m_listener, NULL, NULL);
+            if (fd == host_socket::INVALID) {
+                return;
+            }
+            Client* free_client = NULL;
+            for (Client& client : m_clients) {
+                if (client.fd == host_socket::INVALID) {
+                    free_client = &client;
+                    break;
+                }
+            }
+            if (free_client == NULL || !host_socket::setNonBlocking(fd)) {
+                m_rejected.fetch_add(1, std::memory_order_relaxed);
+                host_socket::close(fd);
+                continue;
+            }
+            *free_client = {};
+            free_client->fd = fd;
+            free_client->slot = -1;
+            free_client->last_active = now;
+            m_client_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void service(Client& client, Clock::time_point now) {
+        client.last_active = now;
+        if (client.remaining > 0) {
+            if (!flush(client)) {
+                return;
+            }
+        }
+        else {
+            long received = host_socket::receive(client.fd, client.request + client.request_length, REQUEST_CAPACITY - client.request_length);
+            if (received <= 0) {
+                if (received < 0 && host_socket::wouldBlock()) {
+                    return;
+                }
+                closeClient(client);
+                return;
+            }
+            client.request_length += static_cast<size_t>(received);
+        }
+        // Answer every complete request in the buffer, keep-alive clients may pipeline
+        while (client.fd != host_socket::INVALID && client.remaining == 0) {
+            size_t length = requestLength(client);
+            if (length == 0) {
+                if (client.request_length == REQUEST_CAPACITY) {
+                    static const char TOO_LARGE[] = "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                    respond(client, TOO_LARGE, sizeof(TOO_LARGE) - 1, -1, true);
+                    flush(client);
+                }
+                return;
+            }
+            answer(client, length);
+            memmove(client.request, client.request + length, client.request_length - length);
+            client.request_length -= length;
+            if (!flush(client)) {
+                return;
+            }
+        }
+    }
+
+    /*
+    * @return bytes up to and including the blank line ending the first request, 0 if it isn't complete yet
+    */
+    static size_t requestLength(const Client& client) {
+        for (size_t i = 3; i < client.request_length; i++) {
+            if (memcmp(client.request + i - 3, "\r\n\r\n", 4) == 0) {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+
+    void answer(Client& client, size_t length) {
+        static const char NOT_FOUND[] = "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 10\r\n\r\nnot found\n";
+        static const char NOT_ALLOWED[] = "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET\r\nContent-Length: 0\r\n\r\n";
+        static const char UNAVAILABLE[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\nContent-Length: 12\r\n\r\nunavailable\n";
+
+        m_requests.fetch_add(1, std::memory_order_relaxed);
+        const char* request = client.request;
+        const char* path = static_cast<const char*>(memchr(request, ' ', length));
+        const char* path_end = path != NULL ? static_cast<const char*>(memchr(path + 1, ' ', length - (path + 1 - request))) : NULL;
+        if (path_end == NULL) {
+            respond(client, NOT_FOUND, sizeof(NOT_FOUND) - 1, -1, true);
+            return;
+        }
+        path++;
+        const char* query = static_cast<const char*>(memchr(path, '?', path_end - path));
+        const size_t path_length = (query != NULL ? query : path_end) - path;
+        // HTTP/1.0 closes unless asked not to, 1.1 keeps the connection unless asked to close
+        const bool http10 = strncmp(path_end, " HTTP/1.0", 9) == 0;
+        const bool close_after = http10 ? !contains(request, length, "keep-alive") : contains(request, length, "close");
+
+        if (path - 1 - request != 3 || memcmp(request, "GET", 3) != 0) {
+            respond(client, NOT_ALLOWED, sizeof(NOT_ALLOWED) - 1, -1, close_after);
+            return;
+        }
+        for (size_t document = 0; document < Documents; document++) {
+            if (strlen(m_routes[document].path) != path_length || memcmp(m_routes[document].path, path, path_length) != 0) {
+                continue;
+            }
+            int slot = pin();
+            if (slot < 0 || m_slots[slot].overflow[document]) {
+                unpin(slot);
+                respond(client, UNAVAILABLE, sizeof(UNAVAILABLE) - 1, -1, close_after);
+                return;
+            }
+            respond(client, m_slots[slot].response[document], m_slots[slot].response_length[document], slot, close_after);
+            return;
+        }
+        respond(client, NOT_FOUND, sizeof(NOT_FOUND) - 1, -1, close_after);
+    }
+
+    /*
+    * @brief case insensitive search for `word` in a Connection header of the request.
+    */
+    static bool contains(const char* request, size_t length, const char* word) {
+        static const char HEADER[] = "\r\nconnection:";
+        const size_t header_length = sizeof(HEADER) - 1;
+        const size_t word_length = strlen(word);
+        for (size_t i = 0; i + header_length <= length; i++) {
+            size_t j = 0;
+            while (j < header_length && lowerCase(request[i + j]) == HEADER[j]) {
+                j++;
+            }
+            if (j < header_length) {
+                continue;
+            }
+            for (size_t k = i + header_length; k + word_length <= length && request[k] != '\r'; k++) {
+                size_t m = 0;
+                while (m < word_length && lowerCase(request[k + m]) == word[m]) {
+                    m++;
+                }
+                if (m == word_length) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    static int lowerCase(char c) {
+        return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+    }
+
+    void respond(Client& client, const char* data, size_t length, int slot, bool close_after) {
+        client.pending = data;
+        client.remaining = length;
+        client.slot = slot;
+        client.close_after = close_after;
+    }
+
+    /*
+    * @brief send what the socket takes of the pending response.
+    * @return true once the response is out and the connection stays open for the next request
+    */
+    bool flush(Client& client) {
+        while (client.remaining > 0) {
+            long sent = host_socket::send(client.fd, client.pending, client.remaining);
+            if (sent < 0 && host_socket::wouldBlock()) {
+                return false;
+            }
+            if (sent <= 0) {
+                closeClient(client);
+                return false;
+            }
+            client.pending += sent;
+            client.remaining -= static_cast<size_t>(sent);
+            m_bytes.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+        }
+        unpin(client.slot);
+        client.slot = -1;
+        if (client.close_after) {
+            closeClient(client);
+            return false;
+        }
+        return true;
+    }
+
+    void closeClient(Client& client) {
+        unpin(client.slot);
+        host_socket::close(client.fd);
+        client.fd = host_socket::INVALID;
+        client.slot = -1;
+        client.remaining = 0;
+        m_client_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /*
+    * @brief pin the current slot. Re-checking after the increment makes sure the producer, which only picks unpinned
+    * slots that aren't current, can't be rendering into the slot a reader ends up with.
+    * @return the slot, -1 if nothing was published yet
+    */
+    int pin() {
+        while (1) {
+            const int slot = m_current.load();
+            if (slot < 0) {
+                return -1;
+            }
+            m_slots[slot].pins.fetch_add(1);
+            if (m_current.load() == slot) {
+                return slot;
+            }
+            m_slots[slot].pins.fetch_sub(1);
+        }
+    }
+
+    void unpin(int slot) {
+        if (slot >= 0) {
+            m_slots[slot].pins.fetch_sub(1);
+        }
+    }
+
+    const Route* m_routes = NULL;
+    std::array<Slot, Slots> m_slots{};
+    std::atomic<int> m_current{ -1 };
+    int m_writing = -1;
+    std::array<Client, MaxClients> m_clients{};
+    std::thread m_thread;
+    std::atomic<bool> m_running{ false };
+    host_socket::Handle m_listener = host_socket::INVALID;
+    std::array<host_socket::PollFd, MaxClients + 1> m_fds{};
+    std::array<size_t, MaxClients + 1> m_owners{}; // client index of each polled descriptor
+    std::atomic<uint32_t> m_published{ 0 };
+    std::atomic<uint32_t> m_skipped{ 0 };
+    std::atomic<uint32_t> m_overflows{ 0 };
+    std::atomic<uint32_t> m_client_count{ 0 };
+    std::atomic<uint32_t> m_rejected{ 0 };
+    std::atomic<uint64_t> m_requests{ 0 };
+    std::atomic<uint64_t> m_bytes{ 0 };
+};
@@ -0,0 +1,180 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+* @brief: Binary telemetry wire format, shared by the exporter and tools/telemetry_decode.cpp.
+*
+* A frame is a batch of records, COBS encoded and terminated by a single 0x00 so a reader can resynchronise
+* after a torn write by skipping to the next zero. Decoded frame layout, all fields little endian:
+*   u8  version (TELEMETRY_VERSION)
+*   u8  record count
+*   u16 frame sequence number, gaps mean lost frames
+*   count * 13 byte records: u8 sensor id, u32 timestamp, f32 raw value, f32 filtered value
+*   u16 CRC-16/CCITT-FALSE over everything before it
+* The timestamp is the monitor's kernel tick count when the processor published the sample, configTICK_RATE_HZ ticks
+* per second (1 ms in the simulator). It counts from the monitor's start and wraps after 2^32 ticks, so readers compare
+* timestamps of one monitor by unsigned difference and never across monitors.
+*/
+static constexpr uint8_t TELEMETRY_VERSION = 1;
+static constexpr size_t TELEMETRY_HEADER_SIZE = 4;
+static constexpr size_t TELEMETRY_RECORD_SIZE = 13;
+static constexpr size_t TELEMETRY_CRC_SIZE = 2;
+static constexpr size_t TELEMETRY_MAX_RECORDS = 32;
+static constexpr size_t TELEMETRY_MAX_FRAME = TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_RECORDS * TELEMETRY_RECORD_SIZE + TELEMETRY_CRC_SIZE;
+// COBS adds one byte per 254 plus the leading code byte, then the 0x00 delimiter
+static constexpr size_t TELEMETRY_MAX_ENCODED = TELEMETRY_MAX_FRAME + TELEMETRY_MAX_FRAME / 254 + 2;
+
+struct TelemetryRecord {
+    uint8_t sensor_id;
+    uint32_t timestamp; // kernel ticks at publish, see the frame layout above
+    float raw;
+    float filtered;
+};
+
+inline uint16_t telemetryCrc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*
+* @brief COBS encode `len` bytes into `out`, which must hold len + len / 254 + 1 bytes. No delimiter is appended.
+* @return encoded length
+*/
+inline size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t code_idx = 0;
+    size_t out_idx = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] != 0) {
+            out[out_idx++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF) {
+            out[code_idx] = code;
+            code = 1;
+            code_idx = out_idx++;
+        }
+    }
+    out[code_idx] = code;
+    return out_idx;
+}
+
+/*
+* @brief COBS decode `len` bytes (without the delimiter) into `out`, which must hold at least len bytes.
+* @return decoded length, 0 if the input is malformed
+*/
+inline size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t in_idx = 0;
+    size_t out_idx = 0;
+    while (in_idx < len) {
+        uint8_t code = in[in_idx++];
+        if (code == 0 || in_idx + code - 1 > len) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            out[out_idx++] = in[in_idx++];
+        }
+        if (code != 0xFF && in_idx < len) {
+            out[out_idx++] = 0;
+        }
+    }
+    return out_idx;
+}
+
+inline void telemetryPutU16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void telemetryPutU32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+inline uint16_t telemetryGetU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t telemetryGetU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+        (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline void telemetryPutF32(uint8_t* p, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    telemetryPutU32(p, bits);
+}
+
+inline float telemetryGetF32(const uint8_t* p) {
+    uint32_t bits = telemetryGetU32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+/*
+* @brief serialize a batch into a complete wire frame: header, records, CRC, COBS, delimiter.
+* @param out at least TELEMETRY_MAX_ENCODED bytes
+* @return bytes to write, 0 if count is out of range
+*/
+inline size_t telemetryEncodeFrame(const TelemetryRecord* records, size_t count, uint16_t sequence, uint8_t* out) {
+    if (count == 0 || count > TELEMETRY_MAX_RECORDS) {
+        return 0;
+    }
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+    frame[0] = TELEMETRY_VERSION;
+    frame[1] = static_cast<uint8_t>(count);
+    telemetryPutU16(frame + 2, sequence);
+    uint8_t* p = frame + TELEMETRY_HEADER_SIZE;
+    for (size_t i = 0; i < count; i++) {
+        p[0] = records[i].sensor_id;
+        telemetryPutU32(p + 1, records[i].timestamp);
+        telemetryPutF32(p + 5, records[i].raw);
+        telemetryPutF32(p + 9, records[i].filtered);
+        p += TELEMETRY_RECORD_SIZE;
+    }
+    size_t len = static_cast<size_t>(p - frame);
+    telemetryPutU16(p, telemetryCrc16(frame, len));
+    len += TELEMETRY_CRC_SIZE;
+
+    size_t encoded = cobsEncode(frame, len, out);
+    out[encoded++] = 0x00;
+    return encoded;
+}
+
+/*
+* @brief parse a decoded (un-COBSed) frame.
+* @return number of records written to `records`, -1 if the frame is truncated, has a bad version or fails the CRC
+*/
+inline int telemetryParseFrame(const uint8_t* frame, size_t len, TelemetryRecord* records, uint16_t* sequence) {
+    if (len < TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE || frame[0] != TELEMETRY_VERSION) {
+        return -1;
+    }
+    size_t count = frame[1];
+    if (count > TELEMETRY_MAX_RECORDS || len != TELEMETRY_HEADER_SIZE + count * TELEMETRY_RECORD_SIZE + TELEMETRY_CRC_SIZE) {
+        return -1;
+    }
+    if (telemetryCrc16(frame, len - TELEMETRY_CRC_SIZE) != telemetryGetU16(frame + len - TELEMETRY_CRC_SIZE)) {
+        return -1;
+    }
+    *sequence = telemetryGetU16(frame + 2);
+    const uint8_t* p = frame + TELEMETRY_HEADER_SIZE;
+    for (size_t i = 0; i < count; i++) {
+        records[i].sensor_id = p[0];
+        records[i].timestamp = telemetryGetU32(p + 1);
+        records[i].raw = telemetryGetF32(p + 5);
+        records[i].filtered = telemetryGetF32(p + 9);
+        p += TELEMETRY_RECORD_SIZE;
+    }
+    return static_cast<int>(count);
+}
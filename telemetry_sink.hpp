@@ -0,0 +1,141 @@
+#pragma once
+#include "host_socket.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#if !defined(_WIN32)
+#include <sys/un.h>
+#endif
+
+/*
+* @brief: Where the binary telemetry stream goes.
+*   STDOUT      - only useful when the dashboard is off or stdout is redirected, frames are binary
+*   FILE        - any path fopen can write: a regular file, a FIFO made with mkfifo, or \\.\pipe\name on Windows
+*   UNIX_SOCKET - connect to a listening SOCK_STREAM Unix domain socket (POSIX host builds only)
+*   UNIX_DATAGRAM - one frame per datagram to a SOCK_DGRAM Unix socket path, e.g. for tools/gateway.cpp. The socket
+*                 autobinds so the receiver can tell senders apart (POSIX host builds only)
+*   UDP         - one frame per datagram to an "ip:port" address, over winsock2 on Windows
+*/
+class TelemetrySink {
+public:
+    enum class Kind { NONE, STDOUT, FILE, UNIX_SOCKET, UNIX_DATAGRAM, UDP };
+
+    ~TelemetrySink() {
+        close();
+    }
+
+    /*
+    * @return false if the destination couldn't be opened, write() then silently discards
+    */
+    bool open(Kind kind, const char* path) {
+        close();
+        switch (kind) {
+        case Kind::STDOUT:
+            m_file = stdout;
+            return true;
+        case Kind::FILE:
+            m_file = fopen(path, "wb");
+            return m_file != NULL;
+        case Kind::UNIX_SOCKET:
+        case Kind::UNIX_DATAGRAM:
+#if !defined(_WIN32)
+        {
+            m_socket = socket(AF_UNIX, kind == Kind::UNIX_SOCKET ? SOCK_STREAM : SOCK_DGRAM, 0);
+            if (m_socket == host_socket::INVALID) {
+                return false;
+            }
+            sockaddr_un addr = {};
+            addr.sun_family = AF_UNIX;
+            // A lone address family autobinds to a unique abstract name (Linux), the gateway keys nodes on it
+            if (kind == Kind::UNIX_DATAGRAM) {
+                bind(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(sa_family_t));
+            }
+            strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+            return connectSocket(reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        }
+#else
+            return false;
+#endif
+        case Kind::UDP:
+        {
+            char host[64];
+            const char* colon = strrchr(path, ':');
+            size_t host_len = colon != NULL ? static_cast<size_t>(colon - path) : 0;
+            if (host_len == 0 || host_len >= sizeof(host)) {
+                return false;
+            }
+            memcpy(host, path, host_len);
+            host[host_len] = '\0';
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(static_cast<uint16_t>(atoi(colon + 1)));
+            if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+                return false;
+            }
+            if (!host_socket::startup()) {
+                return false;
+            }
+            m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+            if (m_socket == host_socket::INVALID) {
+                return false;
+            }
+            return connectSocket(reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        }
+        default:
+            return false;
+        }
+    }
+
+    /*
+    * @return false on a short write, the frame delimiter lets the reader resynchronise on the next frame
+    */
+    bool write(const uint8_t* data, size_t len) {
+        if (m_file != NULL) {
+            bool ok = fwrite(data, 1, len, m_file) == len;
+            fflush(m_file);
+            return ok;
+        }
+        if (m_socket != host_socket::INVALID) {
+            while (len > 0) {
+                long sent = host_socket::send(m_socket, data, len);
+                if (sent <= 0) {
+                    return false;
+                }
+                data += sent;
+                len -= static_cast<size_t>(sent);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool isOpen() const {
+        return m_socket != host_socket::INVALID || m_file != NULL;
+    }
+
+    void close() {
+        if (m_file != NULL && m_file != stdout) {
+            fclose(m_file);
+        }
+        m_file = NULL;
+        if (m_socket != host_socket::INVALID) {
+            host_socket::close(m_socket);
+            m_socket = host_socket::INVALID;
+        }
+    }
+
+private:
+    bool connectSocket(const sockaddr* addr, socklen_t len) {
+        if (connect(m_socket, addr, len) != 0) {
+            host_socket::close(m_socket);
+            m_socket = host_socket::INVALID;
+            return false;
+        }
+        return true;
+    }
+
+    FILE* m_file = NULL;
+    host_socket::Handle m_socket = host_socket::INVALID;
+};
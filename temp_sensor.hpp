@@ -5,7 +5,7 @@
 /*
 * @brief: The TempSensor class is a mock sensor that provides mock data within realistic bounds.
 */
-class TempSensor : public Sensor {
+class TempSensor final : public Sensor {
 public: 
     TempSensor() : Sensor(Type::TEMPERATURE) {}
 
@@ -19,4 +19,15 @@ public:
             m_counter++
         };
     }
+
+    FixedData readFixed() const override {
+        static constexpr uint32_t PHASE_STEP = FixedSine::phaseStep(0.001);
+        Q16_16 base = Q16_16::fromInt(25) + Q16_16::fromInt(5) * FixedSine::sin(m_counter * PHASE_STEP);
+        Q16_16 noise = Q16_16::fromRaw((rand() % 100 - 50) * Q16_16::ONE / 100); // same +-0.5 as read()
+        return {
+            base + noise,
+            Type::TEMPERATURE,
+            m_counter++
+        };
+    }
 };
\ No newline at end of file
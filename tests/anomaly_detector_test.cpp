@@ -0,0 +1,113 @@
+/*
+* @brief: Host side checks for AnomalyDetector: an isolated outlier is a SPIKE and leaves the baseline alone, a step too
+* large for the z-score still ends in a SHIFT after spike_run spikes and the detector then settles on the new level.
+*
+* Build: g++ -std=c++20 -O2 -I.. anomaly_detector_test.cpp -o anomaly_detector_test
+* Usage: anomaly_detector_test   exits non-zero and names the failed check on failure
+*/
+#include "anomaly_detector.hpp"
+#include <cstdio>
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static const AnomalyConfig CONFIG = { 4.0f, 0.5f, 8.0f, 0.05f, 20, 3 };
+
+/*
+* @brief deterministic noise in [-0.5, 0.5], so a failure reproduces.
+*/
+static float noise(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return static_cast<float>(state >> 8) / static_cast<float>(1u << 24) - 0.5f;
+}
+
+static void warmUp(AnomalyDetector& detector, uint32_t& state, float level) {
+    for (uint32_t i = 0; i < 200; i++) {
+        detector.update(level + noise(state));
+    }
+}
+
+static void testIsolatedSpikeIsNotAShift() {
+    AnomalyDetector detector(CONFIG);
+    uint32_t state = 1;
+    warmUp(detector, state, 20.0f);
+
+    CHECK(detector.update(40.0f).kind == AnomalyDetector::Kind::SPIKE);
+    for (uint32_t i = 0; i < 50; i++) {
+        CHECK(detector.update(20.0f + noise(state)).kind == AnomalyDetector::Kind::NONE);
+    }
+    CHECK(detector.getMean() > 19.5f && detector.getMean() < 20.5f);
+}
+
+static void testAlternatingSpikesAreNotAShift() {
+    AnomalyDetector detector(CONFIG);
+    uint32_t state = 2;
+    warmUp(detector, state, 20.0f);
+
+    for (uint32_t i = 0; i < 20; i++) {
+        CHECK(detector.update(i % 2 == 0 ? 40.0f : 0.0f).kind == AnomalyDetector::Kind::SPIKE);
+    }
+}
+
+static void testLargePersistentStepBecomesAShift() {
+    AnomalyDetector detector(CONFIG);
+    uint32_t state = 3;
+    warmUp(detector, state, 20.0f);
+
+    // 40 is about 70 stddevs out, every sample of the step trips the z-score
+    uint32_t spikes = 0;
+    uint32_t shift_at = 0;
+    for (uint32_t i = 1; i <= 20 && shift_at == 0; i++) {
+        AnomalyDetector::Kind kind = detector.update(40.0f + noise(state)).kind;
+        if (kind == AnomalyDetector::Kind::SPIKE) {
+            spikes++;
+        }
+        else if (kind == AnomalyDetector::Kind::SHIFT_UP) {
+            shift_at = i;
+        }
+    }
+    CHECK(spikes >= CONFIG.spike_run);
+    CHECK(shift_at != 0 && shift_at <= CONFIG.spike_run + 4);
+
+    // the baseline restarted, once it has relearned the new level is quiet
+    uint32_t events = 0;
+    for (uint32_t i = 0; i < 200; i++) {
+        if (detector.update(40.0f + noise(state)).kind != AnomalyDetector::Kind::NONE) {
+            events++;
+        }
+    }
+    CHECK(events == 0);
+    CHECK(detector.getMean() > 39.5f && detector.getMean() < 40.5f);
+}
+
+static void testLargeStepDownBecomesAShift() {
+    AnomalyDetector detector(CONFIG);
+    uint32_t state = 4;
+    warmUp(detector, state, 20.0f);
+
+    bool shifted = false;
+    for (uint32_t i = 0; i < 20 && !shifted; i++) {
+        shifted = detector.update(5.0f + noise(state)).kind == AnomalyDetector::Kind::SHIFT_DOWN;
+    }
+    CHECK(shifted);
+}
+
+int main() {
+    testIsolatedSpikeIsNotAShift();
+    testAlternatingSpikesAreNotAShift();
+    testLargePersistentStepBecomesAShift();
+    testLargeStepDownBecomesAShift();
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("anomaly_detector_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*
+* @brief: Host side checks for DerivedMetrics' day handling: the DLI day rolls over after day_ticks of elapsed time
+* wherever the 32 bit tick wraps, a gap of several days leaves yesterday at zero, and temperature and humidity
+* readings straddling the wrap still count as aligned.
+*
+* Build: g++ -std=c++20 -O2 -I.. derived_metrics_test.cpp -o derived_metrics_test
+* Usage: derived_metrics_test   exits non-zero and names the failed check on failure
+*/
+#include "derived_metrics.hpp"
+#include <cstdio>
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static const uint32_t DAY = 86400000; // 1 kHz ticks
+static const DerivedMetrics::Config CONFIG = { 1000, 1000, 10000, DAY, 0.0185f };
+
+/*
+* @brief feed constant light every second from `start` for `seconds`, ticks wrap like the kernel's.
+* @return the tick after the last reading
+*/
+static uint32_t light(DerivedMetrics& metrics, uint32_t start, uint32_t seconds) {
+    uint32_t tick = start;
+    for (uint32_t i = 0; i < seconds; i++) {
+        metrics.update(Sensor::Type::LIGHT, 1000.0f, tick);
+        tick += 1000;
+    }
+    return tick;
+}
+
+static void testWrapDoesNotEndTheDay() {
+    DerivedMetrics metrics;
+    metrics.configure(CONFIG);
+    // start an hour before the wrap and keep going an hour past it, all inside one day
+    light(metrics, 0u - 3600000u, 7200);
+    CHECK(metrics.values().dli_yesterday == 0.0f);
+    CHECK(metrics.values().dli_today > 0.0f);
+}
+
+static void testDayRollsOverAfterDayTicks() {
+    DerivedMetrics metrics;
+    metrics.configure(CONFIG);
+    uint32_t tick = light(metrics, 0u - DAY / 2, 3600);
+    const float first_hour = metrics.values().dli_today;
+    tick = light(metrics, tick - 1000 + DAY - 3600000, 1); // same day, just before it ends, gap not integrated
+    CHECK(metrics.values().dli_yesterday == 0.0f);
+    light(metrics, tick + 3600000, 1); // past the end of the day
+    CHECK(metrics.values().dli_yesterday == first_hour);
+    CHECK(metrics.values().dli_today == 0.0f);
+}
+
+static void testMultiDayGapClearsYesterday() {
+    DerivedMetrics metrics;
+    metrics.configure(CONFIG);
+    uint32_t tick = light(metrics, 5000, 3600);
+    CHECK(metrics.values().dli_today > 0.0f);
+    light(metrics, tick + 3 * DAY, 1);
+    CHECK(metrics.values().dli_yesterday == 0.0f);
+    CHECK(metrics.values().dli_today == 0.0f);
+}
+
+static void testAlignmentAcrossWrap() {
+    DerivedMetrics metrics;
+    metrics.configure(CONFIG);
+    metrics.update(Sensor::Type::TEMPERATURE, 25.0f, 0u - 200u);
+    metrics.update(Sensor::Type::HUMIDITY, 60.0f, 300u);
+    CHECK(metrics.values().aligned);
+    CHECK(metrics.values().vpd > 1.2f && metrics.values().vpd < 1.3f); // es(25 C) = 3.17 kPa, 40 % of it
+}
+
+int main() {
+    testWrapDoesNotEndTheDay();
+    testDayRollsOverAfterDayTicks();
+    testMultiDayGapClearsYesterday();
+    testAlignmentAcrossWrap();
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("derived_metrics_test: all checks passed\n");
+    return 0;
+}
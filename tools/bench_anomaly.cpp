@@ -0,0 +1,55 @@
+/*
+* @brief: Host side benchmark for the anomaly stage's added per sample cost: AnomalyDetector::update() on its own, next
+* to the filter and hourly digest work every reading already pays in the processor. Input is a quiet normal signal
+* with a watering style spike every 200 readings, cycled from a precomputed buffer so generation isn't timed.
+*
+* Build: g++ -std=c++20 -O2 -I.. bench_anomaly.cpp -o bench_anomaly
+* Usage: bench_anomaly [updates]   default 20000000 updates, three runs
+*/
+#include "anomaly_detector.hpp"
+#include "moving_average.hpp"
+#include "quantile_digest.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+static const size_t INPUT_SIZE = 1 << 16;
+static float input[INPUT_SIZE];
+static volatile float sink;
+
+template<typename F>
+static double nsPerUpdate(uint32_t updates, F&& body) {
+    const auto started = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < updates; i++) {
+        body(input[i & (INPUT_SIZE - 1)]);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / updates;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t updates = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], NULL, 10)) : 20000000;
+    std::mt19937 rng(3);
+    std::normal_distribution<float> noise(30.0f, 0.05f);
+    for (size_t i = 0; i < INPUT_SIZE; i++) {
+        input[i] = noise(rng) + (i % 200 == 0 ? 0.5f : 0.0f);
+    }
+
+    for (int run = 0; run < 3; run++) {
+        AnomalyDetector detector({ 3.0f, 0.5f, 8.0f, 0.05f, 20, 3 }); // the humidity configuration from main.cpp
+        uint32_t events = 0;
+        const double detector_ns = nsPerUpdate(updates, [&](float value) {
+            events += detector.update(value).kind != AnomalyDetector::Kind::NONE;
+        });
+
+        MovingAverage<float, 5> filter;
+        WindowedDigest<6, 50> digest(600000);
+        uint32_t tick = 0;
+        const double baseline_ns = nsPerUpdate(updates, [&](float value) {
+            sink = filter.addSample(value);
+            digest.add(tick++, value);
+        });
+        printf("AnomalyDetector::update %.2f ns (%u events), filter + digest %.2f ns per reading\n", detector_ns, events, baseline_ns);
+    }
+    return 0;
+}
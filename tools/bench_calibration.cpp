@@ -0,0 +1,121 @@
+/*
+* @brief: Host side benchmark for CalibrationTable against evaluating the curves directly, ns per sample over a block
+* of readings spread across each curve's range:
+*   cubic, quintic  - temperature correction polynomials with Horner's scheme
+*   piecewise       - search for the segment, then interpolate, the light curve from main.cpp
+*   steinhart-hart  - thermistor resistance to temperature, one log and a division per sample
+*   table apply / applyBatch - the same curves through a 257 point table
+* Each line also prints the table's largest error against the direct curve. Try -O3 -mavx2 as well, the
+* polynomials and applyBatch() vectorize, the piecewise search and the log don't.
+*
+* Build: g++ -std=c++20 -O2 -I.. bench_calibration.cpp -o bench_calibration
+* Usage: bench_calibration [rounds]   default 2000 rounds over 4096 samples
+*/
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "calibration.hpp"
+
+static const size_t SAMPLES = 4096;
+
+static volatile float sink;
+
+template<typename F>
+static double nsPerSample(uint32_t rounds, F&& body) {
+    const auto started = std::chrono::steady_clock::now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        body();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / rounds / SAMPLES;
+}
+
+static float cubic(float x) {
+    return ((-2.0e-7f * x - 0.00011f) * x + 1.004f) * x - 0.12f;
+}
+
+static float quintic(float x) {
+    return ((((1.0e-11f * x - 3.0e-9f) * x - 2.0e-7f) * x - 0.00011f) * x + 1.004f) * x - 0.12f;
+}
+
+static const CalibrationTable<>::Point LIGHT_POINTS[] = { { 0.0f, 0.0f }, { 1000.0f, 1000.0f }, { 5000.0f, 5150.0f }, { 20000.0f, 21800.0f } };
+static const size_t LIGHT_POINT_COUNT = sizeof(LIGHT_POINTS) / sizeof(LIGHT_POINTS[0]);
+
+static float piecewise(float x) {
+    size_t i = 1;
+    while (i < LIGHT_POINT_COUNT - 1 && x > LIGHT_POINTS[i].x) {
+        i++;
+    }
+    const CalibrationTable<>::Point& a = LIGHT_POINTS[i - 1];
+    const CalibrationTable<>::Point& b = LIGHT_POINTS[i];
+    return a.y + (x - a.x) * (b.y - a.y) / (b.x - a.x);
+}
+
+// 10k NTC, resistance in ohms to degrees C, 2k to 40k is about -8 to 65 C
+static float steinhartHart(float r) {
+    const float ln = std::log(r);
+    return 1.0f / (1.129148e-3f + 2.34125e-4f * ln + 8.76741e-8f * ln * ln * ln) - 273.15f;
+}
+
+struct Case {
+    const char* name;
+    float (*curve)(float);
+    float x_min;
+    float x_max;
+};
+
+static void run(const Case& c, uint32_t rounds) {
+    const CalibrationTable<> table = CalibrationTable<>::sampled(c.x_min, c.x_max, [&c](double x) {
+        return static_cast<double>(c.curve(static_cast<float>(x)));
+    });
+    static float in[SAMPLES];
+    static float out[SAMPLES];
+    srand(1);
+    for (size_t i = 0; i < SAMPLES; i++) {
+        in[i] = c.x_min + (c.x_max - c.x_min) * static_cast<float>(rand()) / RAND_MAX;
+    }
+
+    double error = 0.0;
+    for (size_t i = 0; i < SAMPLES; i++) {
+        error = std::fmax(error, std::fabs(static_cast<double>(table.apply(in[i])) - c.curve(in[i])));
+    }
+
+    const double direct = nsPerSample(rounds, [&]() {
+        for (size_t i = 0; i < SAMPLES; i++) {
+            out[i] = c.curve(in[i]);
+        }
+        sink = out[SAMPLES - 1];
+    });
+    const double apply = nsPerSample(rounds, [&]() {
+        for (size_t i = 0; i < SAMPLES; i++) {
+            out[i] = table.apply(in[i]);
+        }
+        sink = out[SAMPLES - 1];
+    });
+    const double batch = nsPerSample(rounds, [&]() {
+        table.applyBatch(in, out, SAMPLES);
+        sink = out[SAMPLES - 1];
+    });
+    printf("%-16s %10.2f %10.2f %12.2f %12.2g\n", c.name, direct, apply, batch, error);
+}
+
+int main(int argc, char** argv) {
+    const uint32_t rounds = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 2000;
+    if (rounds == 0) {
+        fprintf(stderr, "usage: bench_calibration [rounds]\n");
+        return 1;
+    }
+
+    const Case cases[] = {
+        { "cubic", cubic, -40.0f, 85.0f },
+        { "quintic", quintic, -40.0f, 85.0f },
+        { "piecewise", piecewise, 0.0f, 20000.0f },
+        { "steinhart-hart", steinhartHart, 2000.0f, 40000.0f },
+    };
+    printf("ns per sample over %zu samples\n", SAMPLES);
+    printf("%-16s %10s %10s %12s %12s\n", "curve", "direct", "apply", "applyBatch", "max error");
+    for (const Case& c : cases) {
+        run(c, rounds);
+    }
+    return 0;
+}
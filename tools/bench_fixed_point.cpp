@@ -0,0 +1,99 @@
+/*
+* @brief: Host side benchmark for the fixed point filter path against the float one, per mock sensor:
+*   float - read() into MovingAverage<float, 5>
+*   fixed - readFixed() into MovingAverage<Q16_16, 5>, integer math only
+* Accuracy is each filter's largest distance from the exact (double) mean of the readings it was given. The two reads
+* drift apart as the counter grows because read() passes a float angle to sin(), that is the "sensors differ" column.
+* Speed is ns per reading including the read, so it is mostly libm sin() against the sine table. A host FPU hides what
+* the fixed path is for: on a target without one every float operation of the other path is a soft-float call.
+*
+* Build: g++ -std=c++20 -O2 -I.. bench_fixed_point.cpp -o bench_fixed_point
+* Usage: bench_fixed_point [readings]   default 1000000 readings per sensor
+*/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+using std::min;
+using std::max;
+#include "moving_average.hpp"
+#include "temp_sensor.hpp"
+#include "light_sensor.hpp"
+#include "humidity_sensor.hpp"
+
+static const size_t WINDOW = 5;
+
+/*
+* @brief: Exact mean of the last WINDOW readings in double, the reference both filters are held against.
+*/
+struct ExactWindow {
+    double values[WINDOW] = {};
+    size_t next = 0;
+
+    double add(double value) {
+        values[next] = value;
+        next = (next + 1) % WINDOW;
+        double sum = 0.0;
+        for (double v : values) {
+            sum += v;
+        }
+        return sum / WINDOW;
+    }
+};
+
+template<typename S>
+static void compare(uint32_t readings) {
+    S float_sensor;
+    S fixed_sensor;
+    MovingAverage<float, WINDOW> float_filter;
+    MovingAverage<Q16_16, WINDOW> fixed_filter;
+    ExactWindow float_exact;
+    ExactWindow fixed_exact;
+    double float_error = 0.0;
+    double fixed_error = 0.0;
+    double sensor_gap = 0.0;
+    float low = 1e9f;
+    float high = -1e9f;
+
+    for (uint32_t i = 0; i < readings; i++) {
+        srand(i); // both sensors draw the same noise
+        const float value = float_sensor.read().value;
+        srand(i);
+        const Q16_16 fixed = fixed_sensor.readFixed().value;
+        low = std::min(low, value);
+        high = std::max(high, value);
+        sensor_gap = std::max(sensor_gap, std::fabs(static_cast<double>(value) - fixed.toFloat()));
+        float_error = std::max(float_error, std::fabs(float_filter.addSample(value) - float_exact.add(value)));
+        const double fixed_mean = static_cast<double>(fixed_filter.addSample(fixed).raw()) / Q16_16::ONE;
+        fixed_error = std::max(fixed_error, std::fabs(fixed_mean - fixed_exact.add(static_cast<double>(fixed.raw()) / Q16_16::ONE)));
+    }
+
+    srand(1);
+    volatile float float_sink = 0.0f;
+    auto started = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < readings; i++) {
+        float_sink = float_filter.addSample(float_sensor.read().value);
+    }
+    const double float_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / readings;
+    srand(1);
+    volatile int32_t fixed_sink = 0;
+    started = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < readings; i++) {
+        fixed_sink = fixed_filter.addSample(fixed_sensor.readFixed().value).raw();
+    }
+    const double fixed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / readings;
+    (void)float_sink;
+    (void)fixed_sink;
+
+    printf("%-12s range %7.2f..%7.2f | max filter error float %.1e fixed %.1e | sensors differ by %.1e | float %.1f ns fixed %.1f ns\n",
+        Sensor::typeName(float_sensor.getType()), low, high, float_error, fixed_error, sensor_gap, float_ns, fixed_ns);
+}
+
+int main(int argc, char** argv) {
+    const uint32_t readings = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], NULL, 10)) : 1000000;
+    compare<TempSensor>(readings);
+    compare<LightSensor>(readings);
+    compare<HumiditySensor>(readings);
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*
+* @brief: Host side benchmark for the dashboard's hourly percentiles: WindowedDigest<6, 50> (the configuration main.cpp
+* uses) against sorting the exact window, over one hour of readings at 10 Hz from a normal, a lognormal and a uniform
+* distribution. Accuracy is rank error, how far the estimate's rank in the sorted data is from the quantile asked for.
+* Also prints the memory of the digest and of the exact window it replaces.
+*
+* Build: g++ -std=c++20 -O2 -I.. bench_quantiles.cpp -o bench_quantiles
+* Usage: bench_quantiles
+*/
+#include "quantile_digest.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using HourlyDigest = WindowedDigest<6, 50>;
+
+static const size_t READINGS = 36000; // one hour at 10 Hz
+static const double QUANTILES[3] = { 0.05, 0.5, 0.95 };
+static const char* const QUANTILE_NAMES[3] = { "p5", "p50", "p95" };
+
+template<typename F>
+static double nsOf(F&& body) {
+    const auto started = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+}
+
+template<typename Distribution>
+static void compare(const char* name, Distribution distribution, std::mt19937& rng) {
+    std::vector<float> readings(READINGS);
+    for (float& reading : readings) {
+        reading = distribution(rng);
+    }
+
+    HourlyDigest digest(READINGS / 6);
+    const double add_ns = nsOf([&] {
+        for (size_t i = 0; i < READINGS; i++) {
+            digest.add(static_cast<uint32_t>(i), readings[i]);
+        }
+    }) / READINGS;
+    HourlyDigest::Summary summary{};
+    const double summarize_ns = nsOf([&] {
+        for (int i = 0; i < 100; i++) {
+            summary = digest.summarize(READINGS - 1);
+        }
+    }) / 100;
+    std::vector<float> sorted;
+    const double sort_ns = nsOf([&] {
+        for (int i = 0; i < 10; i++) {
+            sorted = readings;
+            std::sort(sorted.begin(), sorted.end());
+        }
+    }) / 10;
+
+    const float estimates[3] = { summary.p5, summary.p50, summary.p95 };
+    printf("%-9s add %.0f ns, summarize %.1f us, exact sort %.0f us |", name, add_ns, summarize_ns / 1000, sort_ns / 1000);
+    for (size_t q = 0; q < 3; q++) {
+        const double rank = static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), estimates[q]) - sorted.begin()) / READINGS;
+        printf(" %s %.3f (exact %.3f, rank error %+.4f)", QUANTILE_NAMES[q], estimates[q],
+            sorted[static_cast<size_t>(QUANTILES[q] * READINGS)], rank - QUANTILES[q]);
+    }
+    printf("\n");
+}
+
+int main() {
+    std::mt19937 rng(7);
+    compare("normal", std::normal_distribution<float>(25.0f, 3.0f), rng);
+    compare("lognormal", std::lognormal_distribution<float>(5.0f, 0.8f), rng);
+    compare("uniform", std::uniform_real_distribution<float>(0.0f, 100.0f), rng);
+    printf("memory: WindowedDigest<6, 50> %zu bytes, exact window %zu bytes\n", sizeof(HourlyDigest), READINGS * sizeof(float));
+    return 0;
+}
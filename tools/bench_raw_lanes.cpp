@@ -0,0 +1,91 @@
+/*
+* @brief: Host side benchmark for RawChannel's priority lanes: tail latency of urgent and normal samples while a bulk
+* flood keeps the raw path overloaded. Drives the real RawChannel over the single threaded stand-in queues in
+* tools/host, in discrete ticks: queue depth 5, the consumer serves one sample per tick, every 4 ticks the producer
+* sends one normal sample and a bulk burst, every 40 ticks one urgent sample. Latency is ticks from send to pickup,
+* "kept" is the share of offered readings that reached the consumer, aggregates counting every reading merged in.
+*
+* Build: g++ -std=c++20 -O2 -I.. -Ihost bench_raw_lanes.cpp -o bench_raw_lanes
+* Usage: bench_raw_lanes   compares a single FIFO with 3 lanes (STRICT, WEIGHTED 4/2/1) under COALESCE and DROP_OLDEST
+*/
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+using std::min;
+using std::max;
+#include "raw_channel.hpp"
+
+static const UBaseType_t DEPTH = 5;
+static const uint32_t TICKS = 2000000;
+static const uint8_t WEIGHTS[3] = { 4, 2, 1 };
+static const char* const LANE_NAMES[3] = { "urgent", "normal", "bulk" };
+
+struct LaneLatency {
+    std::vector<uint32_t> waits;
+    uint32_t offered = 0;
+    uint32_t kept = 0;
+
+    uint32_t percentile(double p) {
+        if (waits.empty()) {
+            return 0;
+        }
+        std::sort(waits.begin(), waits.end());
+        return waits[std::min(waits.size() - 1, static_cast<size_t>(p * waits.size()))];
+    }
+};
+
+static RawSamplePool pool;
+
+static void run(const char* name, size_t lanes, RawChannel::Drain drain, RawChannel::Policy policy, uint32_t burst) {
+    RawChannel channel;
+    channel.create(&pool, DEPTH, policy, lanes, drain, WEIGHTS);
+    LaneLatency latency[3];
+    // urgent samples are temperature, normal humidity and bulk light, so the lane is recoverable from the type
+    const size_t lane_of_type[Sensor::TYPE_COUNT] = { 0, 2, 1 };
+
+    for (host_tick_count = 0; host_tick_count < TICKS; host_tick_count++) {
+        const uint64_t now = host_tick_count;
+        if (now % 40 == 2) {
+            channel.send({ 40.0f, Sensor::Type::TEMPERATURE, now }, 0);
+            latency[0].offered++;
+        }
+        if (now % 4 == 2) {
+            channel.send({ 50.0f, Sensor::Type::HUMIDITY, now }, 1);
+            latency[1].offered++;
+        }
+        if (now % 4 == 0) {
+            for (uint32_t i = 0; i < burst; i++) {
+                channel.send({ 300.0f, Sensor::Type::LIGHT, now }, 2);
+                latency[2].offered++;
+            }
+        }
+        RawChannel::Handle handle;
+        if (channel.receive(handle, 0)) {
+            const RawSample& sample = channel.get(handle);
+            LaneLatency& lane = latency[lane_of_type[static_cast<size_t>(sample.data.type)]];
+            lane.waits.push_back(host_tick_count - sample.enqueued);
+            lane.kept += sample.count;
+            channel.release(handle);
+        }
+    }
+
+    printf("  %-24s", name);
+    for (size_t lane = 0; lane < 3; lane++) {
+        printf(" | %s p50 %2u p99 %2u max %2u kept %5.1f%%", LANE_NAMES[lane], latency[lane].percentile(0.5),
+            latency[lane].percentile(0.99), latency[lane].percentile(1.0), 100.0 * latency[lane].kept / latency[lane].offered);
+    }
+    printf("\n");
+}
+
+int main() {
+    for (uint32_t burst : { 2u, 4u, 8u }) {
+        for (RawChannel::Policy policy : { RawChannel::Policy::COALESCE, RawChannel::Policy::DROP_OLDEST }) {
+            printf("bulk burst of %u every 4 ticks, %s\n", burst, policy == RawChannel::Policy::COALESCE ? "COALESCE" : "DROP_OLDEST");
+            // a single lane channel ignores the lane argument, everything shares one FIFO
+            run("single FIFO", 1, RawChannel::Drain::STRICT, policy, burst);
+            run("3 lanes STRICT", 3, RawChannel::Drain::STRICT, policy, burst);
+            run("3 lanes WEIGHTED 4/2/1", 3, RawChannel::Drain::WEIGHTED, policy, burst);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+* @brief: Host side benchmark for the sensor bus: poll cycle time of 3 and 100 devices read blocking, overlapped one
+* device per transaction and overlapped in batches of 8. Runs vSensorTask's bus loop on a virtual clock with the
+* timings from main.cpp: built-in sensors first, the rest are SENSOR_BUS_LOAD_DEVICES style devices that only occupy
+* the bus. Sleeps round up to whole 1 ms ticks like vTaskDelay(), so the task column includes the tick granularity
+* and the bus column is SensorBus's own cycle time (start until the last result was off the bus).
+*
+* Build: g++ -std=c++20 -O2 -I.. bench_sensor_bus.cpp -o bench_sensor_bus
+* Usage: bench_sensor_bus [cycles]   default 100 cycles per configuration, averaged
+*/
+#include <cstdio>
+#include <cstdlib>
+#include "sensor_bus.hpp"
+
+// same values as main.cpp
+static const SensorBus<>::Timing SENSOR_BUS_TIMING = { 25, 23, 8 };
+static const uint32_t BUILTIN_CONVERSION_US[] = { 10000, 16000, 15000 };
+static const uint8_t BUILTIN_READ_BYTES[] = { 3, 2, 3 };
+static const size_t BUILTIN_COUNT = 3;
+static const uint32_t LOAD_DEVICE_CONVERSION_US = 12000;
+static const uint64_t TICK_US = 1000;
+
+struct Result {
+    double task_ms;
+    double bus_ms;
+    double transactions;
+};
+
+static uint64_t sleepTicks(uint64_t now, uint64_t until) {
+    return now + (until - now + TICK_US - 1) / TICK_US * TICK_US;
+}
+
+static Result run(size_t devices, SensorBus<>::Mode mode, uint32_t max_batch, uint32_t cycles) {
+    SensorBus<> bus;
+    SensorBus<>::Timing timing = SENSOR_BUS_TIMING;
+    timing.max_batch = max_batch;
+    bus.configure(mode, timing);
+    for (size_t i = 0; i < devices; i++) {
+        if (i < BUILTIN_COUNT) {
+            bus.attach(BUILTIN_CONVERSION_US[i], BUILTIN_READ_BYTES[i]);
+        }
+        else {
+            bus.attach(LOAD_DEVICE_CONVERSION_US, 3);
+        }
+    }
+
+    uint64_t now = 0;
+    uint64_t task_us = 0;
+    for (uint32_t c = 0; c < cycles; c++) {
+        const uint64_t started = now;
+        bus.startCycle(now);
+        while (!bus.cycleDone()) {
+            const uint64_t next = bus.nextEvent();
+            if (next > now) {
+                now = sleepTicks(now, next);
+            }
+            // like vSensorTask only the real sensors' results are waited for
+            uint64_t read_at = 0;
+            bus.complete(now, [&](size_t device, uint64_t at) {
+                if (device < BUILTIN_COUNT) {
+                    read_at = at;
+                }
+            });
+            if (read_at > now) {
+                now = sleepTicks(now, read_at);
+            }
+        }
+        task_us += now - started;
+        // next release on a tick boundary with the bus idle
+        now = sleepTicks(now, now + TICK_US);
+    }
+    const SensorBus<>::Stats stats = bus.stats();
+    return { task_us / 1000.0 / cycles, stats.total_cycle_us / 1000.0 / stats.cycles,
+             static_cast<double>(stats.transactions) / stats.cycles };
+}
+
+int main(int argc, char** argv) {
+    const uint32_t cycles = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 100;
+    if (cycles == 0) {
+        fprintf(stderr, "usage: bench_sensor_bus [cycles]\n");
+        return 1;
+    }
+
+    struct Config {
+        const char* name;
+        SensorBus<>::Mode mode;
+        uint32_t max_batch;
+    };
+    const Config configs[] = {
+        { "blocking", SensorBus<>::Mode::BLOCKING, 1 },
+        { "overlapped", SensorBus<>::Mode::OVERLAPPED, 1 },
+        { "overlapped batch 8", SensorBus<>::Mode::OVERLAPPED, 8 },
+    };
+    const size_t sizes[] = { 3, 100 };
+
+    printf("%-20s %8s %10s %10s %14s\n", "mode", "devices", "task ms", "bus ms", "transactions");
+    for (const Config& config : configs) {
+        for (size_t devices : sizes) {
+            const Result result = run(devices, config.mode, config.max_batch, cycles);
+            printf("%-20s %8zu %10.1f %10.1f %14.1f\n", config.name, devices, result.task_ms, result.bus_ms,
+                   result.transactions);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+* @brief: Host side benchmark for sharded processing: throughput of the processor's per reading work (moving average,
+* hourly digest, anomaly detector) when ShardRouter partitions the sensors over 1, 2 and 4 threads, each thread owning
+* its sensors' state like a processor shard does. Readings are generated and routed up front, only processing is timed.
+*
+* Scaling needs as many cores as shards. The program prints how many the host offers and flags every row that has more
+* shards than cores, on a single core host those rows only show the cost of time slicing. The Win32 simulator port
+* runs one task at a time, so this is the figure for SMP targets and host builds, not for the simulator.
+*
+* Build: g++ -std=c++20 -O2 -pthread -I.. bench_shards.cpp -o bench_shards
+* Usage: bench_shards [readings]   default 3000000 readings over 12 sensors
+*/
+#include "shard_router.hpp"
+#include "moving_average.hpp"
+#include "quantile_digest.hpp"
+#include "anomaly_detector.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static const size_t MAX_SHARDS = 4;
+static const size_t SENSORS = 12;
+
+struct SensorState {
+    MovingAverage<float, 5> filter;
+    WindowedDigest<6, 50> digest{ 600000 };
+    AnomalyDetector detector;
+};
+
+int main(int argc, char** argv) {
+    const uint32_t readings = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], NULL, 10)) : 3000000;
+    const unsigned cores = std::thread::hardware_concurrency();
+    printf("%u reading(s) over %zu sensors, host reports %u core(s)\n", readings, SENSORS, cores);
+
+    double base_rate = 0.0;
+    for (size_t shards : { 1, 2, 4 }) {
+        ShardRouter<MAX_SHARDS, SENSORS> router;
+        router.init(shards);
+        std::vector<std::vector<std::pair<size_t, float>>> work(shards);
+        for (uint32_t i = 0; i < readings; i++) {
+            const size_t sensor = i % SENSORS;
+            work[router.route(sensor)].push_back({ sensor, 20.0f + sinf(static_cast<float>(i) * 0.01f) });
+        }
+
+        static SensorState state[SENSORS];
+        std::vector<std::thread> threads;
+        const auto started = std::chrono::steady_clock::now();
+        for (size_t shard = 0; shard < shards; shard++) {
+            threads.emplace_back([&, shard] {
+                uint32_t tick = 0;
+                float sink = 0.0f;
+                for (const auto& [sensor, value] : work[shard]) {
+                    SensorState& s = state[sensor];
+                    sink += s.filter.addSample(value);
+                    s.digest.add(tick++, value);
+                    sink += s.detector.update(value).score;
+                }
+                router.completed(shard, static_cast<uint32_t>(work[shard].size()));
+                if (sink == 1234.5f) {
+                    puts("");
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        const double rate = readings / seconds;
+        if (shards == 1) {
+            base_rate = rate;
+        }
+
+        // the busiest shard bounds the speed-up even with a core per shard, hash partitioning isn't perfectly even
+        size_t busiest = 0;
+        for (const auto& share : work) {
+            busiest = share.size() > busiest ? share.size() : busiest;
+        }
+        printf("shards %zu: %6.2f M readings/s, speed-up %.2fx (bound %.2fx), per shard:", shards, rate / 1e6, rate / base_rate,
+            static_cast<double>(readings) / busiest);
+        for (size_t shard = 0; shard < shards; shard++) {
+            printf(" %zu", work[shard].size());
+        }
+        printf("%s\n", shards > cores ? "  (more shards than cores, no scaling possible)" : "");
+    }
+    return 0;
+}
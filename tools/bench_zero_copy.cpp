@@ -0,0 +1,113 @@
+/*
+* @brief: Host side benchmark for the pooled, handle passing sample path against copying samples by value. Drives the
+* real BlockPool, RawChannel and SampleBus over the stand-in queues in tools/host, which memcpy every item into a ring
+* like the kernel does. Single threaded, queue depth 5, one send and one receive per sample, so the figures are the
+* per sample cost of the path itself, not of contention:
+*   raw path       - RawSample queued by value, vs pool acquire + 2 byte handle + release, vs RawChannel send/receive
+*   processed path - a 3 subscriber SampleBus carrying ProcessedSample by value, vs carrying pooled handles
+*
+* Build: g++ -std=c++20 -O2 -I.. -Ihost bench_zero_copy.cpp -o bench_zero_copy
+* Usage: bench_zero_copy [samples]   default 20000000 samples per case, every case runs three times
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+using std::min;
+using std::max;
+#include "raw_channel.hpp"
+#include "sample_bus.hpp"
+#include "processed_sample.hpp"
+
+static const UBaseType_t DEPTH = 5;
+static const size_t SUBSCRIBERS = 3;
+
+using ProcessedPool = BlockPool<ProcessedSample, 64>;
+using CopyBus = SampleBus<ProcessedSample, 4>;
+using HandleBus = SampleBus<ProcessedPool::Handle, 4, ProcessedPool::Ownership>;
+
+static RawSamplePool raw_pool;
+static ProcessedPool processed_pool;
+static volatile float sink;
+
+template<typename F>
+static double nsPerSample(uint32_t samples, F&& body) {
+    const auto started = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < samples; i++) {
+        body(i);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / samples;
+}
+
+static Sensor::Data reading(uint32_t i) {
+    return { static_cast<float>(i), Sensor::Type::LIGHT, i };
+}
+
+int main(int argc, char** argv) {
+    const uint32_t samples = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], NULL, 10)) : 20000000;
+    printf("sizeof RawSample %zu, ProcessedSample %zu, handle %zu, ns per sample:\n",
+        sizeof(RawSample), sizeof(ProcessedSample), sizeof(RawChannel::Handle));
+
+    QueueHandle_t by_value = xQueueCreate(DEPTH, sizeof(RawSample));
+    QueueHandle_t by_handle = xQueueCreate(DEPTH, sizeof(RawChannel::Handle));
+    RawChannel channel;
+    channel.create(&raw_pool, DEPTH, RawChannel::Policy::DROP_NEWEST);
+    CopyBus copy_bus;
+    HandleBus handle_bus{ ProcessedPool::Ownership{ &processed_pool } };
+    CopyBus::Handle copy_subs[SUBSCRIBERS];
+    HandleBus::Handle handle_subs[SUBSCRIBERS];
+    for (size_t s = 0; s < SUBSCRIBERS; s++) {
+        copy_subs[s] = copy_bus.subscribe("copy", DEPTH, CopyBus::OverflowPolicy::DROP_OLDEST);
+        handle_subs[s] = handle_bus.subscribe("handle", DEPTH, HandleBus::OverflowPolicy::DROP_OLDEST);
+    }
+
+    for (int run = 0; run < 3; run++) {
+        const double raw_copy = nsPerSample(samples, [&](uint32_t i) {
+            const Sensor::Data data = reading(i);
+            RawSample sample = { data, data.value, data.value, 1, 0, 0, Q16_16() };
+            xQueueSend(by_value, &sample, 0);
+            xQueueReceive(by_value, &sample, 0);
+            sink = sample.data.value;
+        });
+        const double raw_handle = nsPerSample(samples, [&](uint32_t i) {
+            const Sensor::Data data = reading(i);
+            RawChannel::Handle handle = raw_pool.acquire();
+            raw_pool.get(handle) = { data, data.value, data.value, 1, 0, 0, Q16_16() };
+            xQueueSend(by_handle, &handle, 0);
+            xQueueReceive(by_handle, &handle, 0);
+            sink = raw_pool.get(handle).data.value;
+            raw_pool.release(handle);
+        });
+        const double raw_channel = nsPerSample(samples, [&](uint32_t i) {
+            channel.send(reading(i));
+            RawChannel::Handle handle;
+            channel.receive(handle, 0);
+            sink = channel.get(handle).data.value;
+            channel.release(handle);
+        });
+        const double bus_copy = nsPerSample(samples, [&](uint32_t i) {
+            copy_bus.publish({ reading(i), 1.0f, i });
+            for (size_t s = 0; s < SUBSCRIBERS; s++) {
+                ProcessedSample out;
+                copy_bus.receive(copy_subs[s], out, 0);
+                sink = out.filtered;
+                copy_bus.release(out);
+            }
+        });
+        const double bus_handle = nsPerSample(samples, [&](uint32_t i) {
+            ProcessedPool::Handle handle = processed_pool.acquire();
+            processed_pool.get(handle) = { reading(i), 1.0f, i };
+            handle_bus.publish(handle);
+            processed_pool.release(handle); // subscribers hold their own references now
+            for (size_t s = 0; s < SUBSCRIBERS; s++) {
+                ProcessedPool::Handle out;
+                handle_bus.receive(handle_subs[s], out, 0);
+                sink = processed_pool.get(out).filtered;
+                handle_bus.release(out);
+            }
+        });
+        printf("raw: by value %5.1f, pool handle %5.1f, RawChannel %5.1f | bus x%zu: by value %5.1f, pool handle %5.1f\n",
+            raw_copy, raw_handle, raw_channel, SUBSCRIBERS, bus_copy, bus_handle);
+    }
+    return 0;
+}
@@ -0,0 +1,627 @@
+/*
+* @brief: Host side gateway that merges the telemetry of many plant monitors into one dashboard.
+* Monitors send their frames as datagrams (TELEMETRY_SINK = UDP or UNIX_DATAGRAM in main.cpp), one frame per datagram,
+* and are told apart by their source address. Ingestion is sharded: every shard thread runs its own epoll loop over
+* its own sockets and owns the state of the nodes that land on it, so the receive path shares and locks nothing.
+*   UDP  - all shards bind the same port with SO_REUSEPORT, the kernel hashes each sender to one shard
+*   Unix - shard i binds <path>.<i>, a node sends to one of them and stays there
+* Ready sockets are drained with recvmmsg, RECV_BATCH datagrams per call. A node keeps the same moving average the
+* monitor uses per sensor, plus frame and sequence accounting. Shards publish a summary every SUMMARY_PERIOD that
+* the dashboard merges, the only lock is the per shard summary mutex.
+*
+* -n simulates that many nodes from sender threads (one socket per node) for -d seconds and prints the ingest rate.
+*
+* Build: g++ -std=c++20 -O2 -I.. gateway.cpp -o gateway -pthread   (Linux only)
+* Usage: gateway [-u port] [-x path] [-s shards] [-d seconds]
+*        gateway -n nodes [-r frames/s per node, 0 = flood] [-b records per frame] [-t sender threads] ...
+*/
+#include "moving_average.hpp"
+#include "telemetry_format.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static const char* const SENSOR_NAMES[] = { "Temperature", "Light", "Humidity" };
+static const char* const SENSOR_UNITS[] = { "C", "lux", "%" };
+static const size_t SENSOR_COUNT = sizeof(SENSOR_NAMES) / sizeof(SENSOR_NAMES[0]);
+
+static const size_t NODE_FILTER_WINDOW = 5;        // same as FILTER_WINDOW in main.cpp
+static const size_t NODE_TABLE_SIZE = 4096;        // per shard, power of two
+static const size_t MAX_NODES_PER_SHARD = NODE_TABLE_SIZE * 3 / 4;
+static const size_t MAX_SHARDS = 16;
+static const size_t RECV_BATCH = 64;
+static const size_t MAX_EVENTS = 16;
+static const int RECEIVE_BUFFER_BYTES = 4 << 20;
+static const auto SUMMARY_PERIOD = std::chrono::milliseconds(250);
+static const auto DASHBOARD_PERIOD = std::chrono::seconds(1);
+static const auto STALE_AFTER = std::chrono::seconds(5);
+static const size_t STALE_LISTED = 5;
+static const uint16_t LATE_WINDOW = 64;            // a frame this far behind is late or duplicated, further back the node restarted
+
+struct Options {
+    int udp_port = 9100;
+    const char* unix_path = NULL;
+    size_t shards = 4;
+    double seconds = 0.0;      // 0 = run until killed, 10 when simulating
+    size_t sim_nodes = 0;
+    double sim_rate = 2.0;     // frames per node per second, the monitor's TELEMETRY_FLUSH_PERIOD is 500 ms
+    size_t sim_records = TELEMETRY_MAX_RECORDS;
+    size_t sim_threads = 4;
+};
+
+struct Address {
+    sockaddr_storage storage;
+    socklen_t len;
+
+    bool operator==(const Address& other) const {
+        return len == other.len && memcmp(&storage, &other.storage, len) == 0;
+    }
+
+    uint64_t hash() const {
+        uint64_t h = 14695981039346656037ull; // FNV-1a
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&storage);
+        for (socklen_t i = 0; i < len; i++) {
+            h = (h ^ p[i]) * 1099511628211ull;
+        }
+        return h;
+    }
+
+    void format(char* out, size_t size) const {
+        if (storage.ss_family == AF_INET) {
+            const sockaddr_in* in = reinterpret_cast<const sockaddr_in*>(&storage);
+            char ip[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &in->sin_addr, ip, sizeof(ip));
+            snprintf(out, size, "%s:%u", ip, (unsigned)ntohs(in->sin_port));
+        }
+        else {
+            // Autobound names are abstract: a leading NUL and five hex digits
+            const sockaddr_un* un = reinterpret_cast<const sockaddr_un*>(&storage);
+            size_t path_len = len > offsetof(sockaddr_un, sun_path) ? len - offsetof(sockaddr_un, sun_path) : 0;
+            if (path_len > 0 && un->sun_path[0] == '\0') {
+                snprintf(out, size, "@%.*s", (int)(path_len - 1), un->sun_path + 1);
+            }
+            else {
+                snprintf(out, size, "%.*s", (int)path_len, un->sun_path);
+            }
+        }
+    }
+};
+
+struct Node {
+    bool used;
+    Address address;
+    Clock::time_point last_seen;
+    uint16_t expected;
+    unsigned long frames;
+    unsigned long lost_frames;
+    unsigned long resyncs;
+    bool seen[SENSOR_COUNT];
+    MovingAverage<float, NODE_FILTER_WINDOW> average[SENSOR_COUNT];
+};
+
+struct SensorSummary {
+    unsigned long nodes;
+    double sum;
+    float min;
+    float max;
+};
+
+struct StaleNode {
+    char name[48];
+    double age;
+};
+
+struct ShardSummary {
+    unsigned long nodes;
+    unsigned long frames;
+    unsigned long records;
+    unsigned long bad_frames;
+    unsigned long lost_frames;
+    unsigned long resyncs;   // sequence restarts, counted instead of losses
+    unsigned long rejected;  // node table full
+    unsigned long stale;
+    SensorSummary sensors[SENSOR_COUNT];
+    StaleNode stalest[STALE_LISTED];
+    size_t stalest_count;
+};
+
+/*
+* @brief one ingestion thread: its sockets, its epoll loop and the nodes hashed to it.
+*/
+class Shard {
+public:
+    Shard() : m_nodes(NODE_TABLE_SIZE) {}
+
+    ~Shard() {
+        for (int fd : m_sockets) {
+            close(fd);
+        }
+        if (m_epoll >= 0) {
+            close(m_epoll);
+        }
+    }
+
+    bool open(const Options& options, size_t index) {
+        m_epoll = epoll_create1(0);
+        if (m_epoll < 0) {
+            return false;
+        }
+        if (options.udp_port > 0) {
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(static_cast<uint16_t>(options.udp_port));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (!addSocket(AF_INET, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))) {
+                return false;
+            }
+        }
+        if (options.unix_path != NULL) {
+            sockaddr_un addr = {};
+            addr.sun_family = AF_UNIX;
+            snprintf(addr.sun_path, sizeof(addr.sun_path), "%s.%u", options.unix_path, (unsigned)index);
+            unlink(addr.sun_path);
+            if (!addSocket(AF_UNIX, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void run(const std::atomic<bool>& running) {
+        epoll_event events[MAX_EVENTS];
+        Clock::time_point published = Clock::now();
+        while (running.load(std::memory_order_relaxed)) {
+            int ready = epoll_wait(m_epoll, events, MAX_EVENTS, static_cast<int>(SUMMARY_PERIOD.count()));
+            for (int i = 0; i < ready; i++) {
+                drain(events[i].data.fd);
+            }
+            Clock::time_point now = Clock::now();
+            if (now - published >= SUMMARY_PERIOD) {
+                publish(now);
+                published = now;
+            }
+        }
+        publish(Clock::now());
+    }
+
+    ShardSummary summary() {
+        std::lock_guard<std::mutex> lock(m_summary_mutex);
+        return m_summary;
+    }
+
+private:
+    bool addSocket(int family, const sockaddr* addr, socklen_t len) {
+        int fd = socket(family, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        if (fd < 0) {
+            return false;
+        }
+        m_sockets.push_back(fd);
+        int one = 1;
+        if (family == AF_INET) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+        }
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &RECEIVE_BUFFER_BYTES, sizeof(RECEIVE_BUFFER_BYTES));
+        if (bind(fd, addr, len) != 0) {
+            return false;
+        }
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        return epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    /*
+    * @brief read until the socket is empty, RECV_BATCH datagrams per system call.
+    */
+    void drain(int fd) {
+        static thread_local uint8_t buffers[RECV_BATCH][TELEMETRY_MAX_ENCODED];
+        static thread_local Address sources[RECV_BATCH];
+        static thread_local iovec iov[RECV_BATCH];
+        static thread_local mmsghdr messages[RECV_BATCH];
+        while (1) {
+            for (size_t i = 0; i < RECV_BATCH; i++) {
+                iov[i] = { buffers[i], sizeof(buffers[i]) };
+                messages[i].msg_hdr = {};
+                messages[i].msg_hdr.msg_iov = &iov[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+                messages[i].msg_hdr.msg_name = &sources[i].storage;
+                messages[i].msg_hdr.msg_namelen = sizeof(sources[i].storage);
+            }
+            int received = recvmmsg(fd, messages, RECV_BATCH, MSG_DONTWAIT, NULL);
+            if (received <= 0) {
+                return;
+            }
+            Clock::time_point now = Clock::now();
+            for (int i = 0; i < received; i++) {
+                sources[i].len = messages[i].msg_hdr.msg_namelen;
+                handleDatagram(sources[i], buffers[i], messages[i].msg_len, messages[i].msg_hdr.msg_flags, now);
+            }
+            if (received < static_cast<int>(RECV_BATCH)) {
+                return;
+            }
+        }
+    }
+
+    void handleDatagram(const Address& source, const uint8_t* data, size_t len, int flags, Clock::time_point now) {
+        uint8_t frame[TELEMETRY_MAX_ENCODED];
+        TelemetryRecord records[TELEMETRY_MAX_RECORDS];
+        uint16_t sequence;
+
+        if (len > 0 && data[len - 1] == 0x00) {
+            len--; // the stream delimiter, redundant in a datagram
+        }
+        size_t decoded = (flags & MSG_TRUNC) == 0 && len > 0 ? cobsDecode(data, len, frame) : 0;
+        int count = decoded > 0 ? telemetryParseFrame(frame, decoded, records, &sequence) : -1;
+        if (count < 0) {
+            m_bad_frames++;
+            return;
+        }
+        Node* node = find(source);
+        if (node == NULL) {
+            m_rejected++;
+            return;
+        }
+        trackSequence(*node, sequence);
+        node->frames++;
+        node->last_seen = now;
+        for (int i = 0; i < count; i++) {
+            if (records[i].sensor_id < SENSOR_COUNT) {
+                node->average[records[i].sensor_id].addSample(records[i].raw);
+                node->seen[records[i].sensor_id] = true;
+            }
+        }
+        m_frames++;
+        m_records += static_cast<unsigned long>(count);
+    }
+
+    /*
+    * @brief frame loss accounting on the 16 bit sequence. A gap of less than half the range forward is frames lost,
+    * anything else is the sequence going backwards: a late or duplicated datagram within LATE_WINDOW is ignored,
+    * further back the node restarted (or wrapped past half the range while quiet) and the count resyncs to it.
+    */
+    static void trackSequence(Node& node, uint16_t sequence) {
+        if (node.frames == 0) {
+            node.expected = static_cast<uint16_t>(sequence + 1);
+            return;
+        }
+        const uint16_t ahead = static_cast<uint16_t>(sequence - node.expected);
+        if (ahead < 0x8000) {
+            node.lost_frames += ahead;
+            node.expected = static_cast<uint16_t>(sequence + 1);
+            return;
+        }
+        const uint16_t behind = static_cast<uint16_t>(node.expected - sequence);
+        if (behind <= LATE_WINDOW) {
+            return;
+        }
+        node.resyncs++;
+        node.expected = static_cast<uint16_t>(sequence + 1);
+    }
+
+    /*
+    * @brief the node sending from `address`, added on first contact. Open addressing with linear probing, nodes are
+    * never removed so probing never has to skip holes.
+    * @return NULL if the shard already tracks MAX_NODES_PER_SHARD nodes
+    */
+    Node* find(const Address& address) {
+        size_t slot = address.hash() & (NODE_TABLE_SIZE - 1);
+        while (m_nodes[slot].used) {
+            if (m_nodes[slot].address == address) {
+                return &m_nodes[slot];
+            }
+            slot = (slot + 1) & (NODE_TABLE_SIZE - 1);
+        }
+        if (m_node_count >= MAX_NODES_PER_SHARD) {
+            return NULL;
+        }
+        m_node_count++;
+        m_nodes[slot].used = true;
+        m_nodes[slot].address = address;
+        return &m_nodes[slot];
+    }
+
+    void publish(Clock::time_point now) {
+        ShardSummary summary = {};
+        summary.nodes = m_node_count;
+        summary.frames = m_frames;
+        summary.records = m_records;
+        summary.bad_frames = m_bad_frames;
+        summary.rejected = m_rejected;
+        for (SensorSummary& sensor : summary.sensors) {
+            sensor.min = INFINITY;
+            sensor.max = -INFINITY;
+        }
+        for (const Node& node : m_nodes) {
+            if (!node.used) {
+                continue;
+            }
+            summary.lost_frames += node.lost_frames;
+            summary.resyncs += node.resyncs;
+            const double age = std::chrono::duration<double>(now - node.last_seen).count();
+            if (now - node.last_seen >= STALE_AFTER) {
+                summary.stale++;
+                addStale(summary, node, age);
+                continue;
+            }
+            for (size_t s = 0; s < SENSOR_COUNT; s++) {
+                if (!node.seen[s]) {
+                    continue;
+                }
+                const float value = node.average[s].getAverage();
+                SensorSummary& sensor = summary.sensors[s];
+                sensor.nodes++;
+                sensor.sum += value;
+                sensor.min = std::min(sensor.min, value);
+                sensor.max = std::max(sensor.max, value);
+            }
+        }
+        std::lock_guard<std::mutex> lock(m_summary_mutex);
+        m_summary = summary;
+    }
+
+    /*
+    * @brief keep the STALE_LISTED longest silent nodes, oldest first.
+    */
+    static void addStale(ShardSummary& summary, const Node& node, double age) {
+        size_t i = summary.stalest_count < STALE_LISTED ? summary.stalest_count++ : STALE_LISTED;
+        while (i > 0 && summary.stalest[i - 1].age < age) {
+            if (i < STALE_LISTED) {
+                summary.stalest[i] = summary.stalest[i - 1];
+            }
+            i--;
+        }
+        if (i < STALE_LISTED) {
+            summary.stalest[i].age = age;
+            node.address.format(summary.stalest[i].name, sizeof(summary.stalest[i].name));
+        }
+    }
+
+    int m_epoll = -1;
+    std::vector<int> m_sockets;
+    std::vector<Node> m_nodes;
+    size_t m_node_count = 0;
+    unsigned long m_frames = 0;
+    unsigned long m_records = 0;
+    unsigned long m_bad_frames = 0;
+    unsigned long m_rejected = 0;
+    std::mutex m_summary_mutex;
+    ShardSummary m_summary = {};
+};
+
+/*
+* @brief merge the shard summaries and print the combined dashboard.
+* @return the merged totals, for the rate of the next call
+*/
+static ShardSummary printDashboard(std::vector<Shard>& shards, const ShardSummary& previous, double seconds, bool clear) {
+    ShardSummary total = {};
+    std::vector<ShardSummary> per_shard;
+    std::vector<StaleNode> stalest;
+    for (SensorSummary& sensor : total.sensors) {
+        sensor.min = INFINITY;
+        sensor.max = -INFINITY;
+    }
+    for (Shard& shard : shards) {
+        ShardSummary summary = shard.summary();
+        per_shard.push_back(summary);
+        total.nodes += summary.nodes;
+        total.frames += summary.frames;
+        total.records += summary.records;
+        total.bad_frames += summary.bad_frames;
+        total.lost_frames += summary.lost_frames;
+        total.resyncs += summary.resyncs;
+        total.rejected += summary.rejected;
+        total.stale += summary.stale;
+        for (size_t s = 0; s < SENSOR_COUNT; s++) {
+            total.sensors[s].nodes += summary.sensors[s].nodes;
+            total.sensors[s].sum += summary.sensors[s].sum;
+            total.sensors[s].min = std::min(total.sensors[s].min, summary.sensors[s].min);
+            total.sensors[s].max = std::max(total.sensors[s].max, summary.sensors[s].max);
+        }
+        stalest.insert(stalest.end(), summary.stalest, summary.stalest + summary.stalest_count);
+    }
+
+    if (clear) {
+        printf("\033[2J\033[H");
+    }
+    printf("=== Plant Monitor Gateway: %lu nodes, %lu stale, %zu shards ===\n", total.nodes, total.stale, shards.size());
+    printf("Ingest  %.0f frames/s  %.0f records/s  (%lu frames, %lu bad, %lu lost, %lu resyncs, %lu rejected)\n",
+        (total.frames - previous.frames) / seconds, (total.records - previous.records) / seconds,
+        total.frames, total.bad_frames, total.lost_frames, total.resyncs, total.rejected);
+    for (size_t s = 0; s < SENSOR_COUNT; s++) {
+        const SensorSummary& sensor = total.sensors[s];
+        if (sensor.nodes == 0) {
+            printf("%-12s no live nodes\n", SENSOR_NAMES[s]);
+            continue;
+        }
+        printf("%-12s %5lu nodes  mean %8.2f %s  min %8.2f  max %8.2f\n", SENSOR_NAMES[s], sensor.nodes,
+            sensor.sum / sensor.nodes, SENSOR_UNITS[s], sensor.min, sensor.max);
+    }
+    for (size_t i = 0; i < per_shard.size(); i++) {
+        printf("Shard %zu  %5lu nodes  %10lu frames\n", i, per_shard[i].nodes, per_shard[i].frames);
+    }
+    std::sort(stalest.begin(), stalest.end(), [](const StaleNode& a, const StaleNode& b) { return a.age > b.age; });
+    for (size_t i = 0; i < stalest.size() && i < STALE_LISTED; i++) {
+        printf("STALE %-24s silent %.0f s\n", stalest[i].name, stalest[i].age);
+    }
+    fflush(stdout);
+    return total;
+}
+
+/*
+* @brief one sender thread of the simulation, nodes [first, last) each with a socket of their own so the gateway sees
+* distinct source addresses. Values wander per node around plausible indoor readings.
+*/
+static void simulateNodes(const Options& options, size_t first, size_t last, const std::atomic<bool>& running,
+    std::atomic<unsigned long>& sent) {
+    std::vector<int> sockets;
+    for (size_t node = first; node < last; node++) {
+        int fd;
+        if (options.unix_path != NULL) {
+            fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+            sockaddr_un addr = {};
+            addr.sun_family = AF_UNIX;
+            bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(sa_family_t)); // autobind, see TelemetrySink
+            snprintf(addr.sun_path, sizeof(addr.sun_path), "%s.%u", options.unix_path, (unsigned)(node % options.shards));
+            connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        }
+        else {
+            fd = socket(AF_INET, SOCK_DGRAM, 0);
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(static_cast<uint16_t>(options.udp_port));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        }
+        sockets.push_back(fd);
+    }
+
+    std::vector<uint16_t> sequence(sockets.size(), 0);
+    TelemetryRecord records[TELEMETRY_MAX_RECORDS];
+    uint8_t frame[TELEMETRY_MAX_ENCODED];
+    uint32_t timestamp = 0;
+    unsigned long local_sent = 0;
+    const auto period = options.sim_rate > 0.0 ?
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.sim_rate)) : Clock::duration::zero();
+    Clock::time_point next = Clock::now();
+
+    while (running.load(std::memory_order_relaxed)) {
+        for (size_t i = 0; i < sockets.size(); i++) {
+            const float offset = static_cast<float>((first + i) % 10);
+            for (size_t r = 0; r < options.sim_records; r++) {
+                const uint8_t sensor = static_cast<uint8_t>(r % SENSOR_COUNT);
+                const float wave = std::sin(timestamp * 0.001f + offset);
+                const float value = sensor == 0 ? 20.0f + offset + wave : sensor == 1 ? 500.0f + 100.0f * wave : 50.0f + 5.0f * wave;
+                records[r] = { sensor, timestamp + static_cast<uint32_t>(r), value, value };
+            }
+            size_t len = telemetryEncodeFrame(records, options.sim_records, sequence[i]++, frame);
+            if (send(sockets[i], frame, len, 0) == static_cast<ssize_t>(len)) {
+                local_sent++;
+            }
+        }
+        timestamp += 100;
+        if (period != Clock::duration::zero()) {
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    }
+    sent.fetch_add(local_sent);
+    for (int fd : sockets) {
+        close(fd);
+    }
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    bool udp_given = false;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc || argv[i][0] != '-' || argv[i][2] != '\0') {
+            return false;
+        }
+        const char* value = argv[++i];
+        switch (argv[i - 1][1]) {
+        case 'u': options.udp_port = atoi(value); udp_given = true; break;
+        case 'x': options.unix_path = value; break;
+        case 's': options.shards = static_cast<size_t>(atoi(value)); break;
+        case 'd': options.seconds = atof(value); break;
+        case 'n': options.sim_nodes = static_cast<size_t>(atoi(value)); break;
+        case 'r': options.sim_rate = atof(value); break;
+        case 'b': options.sim_records = static_cast<size_t>(atoi(value)); break;
+        case 't': options.sim_threads = static_cast<size_t>(atoi(value)); break;
+        default: return false;
+        }
+    }
+    if (options.unix_path != NULL && !udp_given) {
+        options.udp_port = 0;
+    }
+    if (options.sim_nodes > 0 && options.seconds <= 0.0) {
+        options.seconds = 10.0;
+    }
+    options.sim_threads = std::max<size_t>(1, std::min(options.sim_threads, std::max<size_t>(1, options.sim_nodes)));
+    return options.shards >= 1 && options.shards <= MAX_SHARDS && options.sim_records >= 1 &&
+        options.sim_records <= TELEMETRY_MAX_RECORDS && (options.udp_port > 0 || options.unix_path != NULL);
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "usage: gateway [-u port] [-x path] [-s shards 1..%zu] [-d seconds] [-n nodes] [-r rate] [-b records 1..%zu] [-t threads]\n",
+            MAX_SHARDS, TELEMETRY_MAX_RECORDS);
+        return 1;
+    }
+
+    std::vector<Shard> shards(options.shards);
+    for (size_t i = 0; i < shards.size(); i++) {
+        if (!shards[i].open(options, i)) {
+            perror("gateway socket");
+            return 1;
+        }
+    }
+    std::atomic<bool> running{ true };
+    std::vector<std::thread> shard_threads;
+    for (Shard& shard : shards) {
+        shard_threads.emplace_back([&shard, &running] { shard.run(running); });
+    }
+
+    std::atomic<bool> simulating{ true };
+    std::atomic<unsigned long> sent{ 0 };
+    std::vector<std::thread> senders;
+    for (size_t t = 0; t < options.sim_threads && options.sim_nodes > 0; t++) {
+        const size_t first = options.sim_nodes * t / options.sim_threads;
+        const size_t last = options.sim_nodes * (t + 1) / options.sim_threads;
+        senders.emplace_back(simulateNodes, std::cref(options), first, last, std::cref(simulating), std::ref(sent));
+    }
+
+    const Clock::time_point start = Clock::now();
+    const bool interactive = options.sim_nodes == 0;
+    ShardSummary previous = {};
+    Clock::time_point last = start;
+    while (options.seconds <= 0.0 || Clock::now() - start < std::chrono::duration<double>(options.seconds)) {
+        std::this_thread::sleep_for(DASHBOARD_PERIOD);
+        Clock::time_point now = Clock::now();
+        previous = printDashboard(shards, previous, std::chrono::duration<double>(now - last).count(), interactive);
+        last = now;
+    }
+
+    simulating = false;
+    const Clock::time_point stopped = Clock::now();
+    for (std::thread& sender : senders) {
+        sender.join();
+    }
+    std::this_thread::sleep_for(SUMMARY_PERIOD * 2); // let the shards drain what is still queued
+    running = false;
+    for (std::thread& thread : shard_threads) {
+        thread.join();
+    }
+
+    if (options.sim_nodes > 0) {
+        const double seconds = std::chrono::duration<double>(stopped - start).count();
+        ShardSummary total = printDashboard(shards, {}, seconds, false);
+        const unsigned long sent_frames = sent.load();
+        printf("\nSimulated %zu nodes over %s, %zu shards, %zu records/frame: sent %lu frames, received %lu (%.2f%% dropped)\n",
+            options.sim_nodes, options.unix_path != NULL ? "Unix datagrams" : "UDP", options.shards, options.sim_records,
+            sent_frames, total.frames, sent_frames > 0 ? 100.0 * (sent_frames - std::min(sent_frames, total.frames)) / sent_frames : 0.0);
+        printf("Ingest rate %.0f frames/s, %.0f records/s\n", total.frames / seconds, total.records / seconds);
+    }
+    if (options.unix_path != NULL) {
+        for (size_t i = 0; i < shards.size(); i++) {
+            char path[sizeof(sockaddr_un::sun_path)];
+            snprintf(path, sizeof(path), "%s.%u", options.unix_path, (unsigned)i);
+            unlink(path);
+        }
+    }
+    return 0;
+}
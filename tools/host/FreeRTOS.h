@@ -0,0 +1,19 @@
+#pragma once
+/*
+* @brief: Single threaded host stand-in for the slice of the FreeRTOS API the header-only modules use, so the
+* benchmarks in tools/ can drive the real RawChannel, SampleBus and BlockPool without a kernel. Nothing ever blocks:
+* timeouts are ignored, a send to a full queue fails and a receive from an empty one fails.
+* The tick only moves when the program sets host_tick_count. Not part of the simulator build.
+*/
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
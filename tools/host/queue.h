@@ -0,0 +1,93 @@
+#pragma once
+/*
+* @brief: Host stand-in for queue.h, see FreeRTOS.h in this directory. Items are copied into a ring like the kernel
+* does, so copying cost scales with the item size the same way. A queue set counts the items queued in its members.
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_QUEUE_SET_MEMBERS 8
+
+typedef struct QueueDefinition {
+    uint8_t* ring;
+    UBaseType_t depth;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    struct QueueDefinition* set;
+    struct QueueDefinition* members[HOST_QUEUE_SET_MEMBERS];
+    UBaseType_t member_count;
+} QueueDefinition;
+
+typedef QueueDefinition* QueueHandle_t;
+typedef QueueDefinition* QueueSetHandle_t;
+typedef QueueDefinition* QueueSetMemberHandle_t;
+
+static inline QueueHandle_t xQueueCreate(UBaseType_t depth, UBaseType_t item_size) {
+    QueueDefinition* queue = (QueueDefinition*)calloc(1, sizeof(QueueDefinition));
+    if (queue != NULL) {
+        queue->depth = depth;
+        queue->item_size = item_size;
+        queue->ring = (uint8_t*)calloc(depth, item_size > 0 ? item_size : 1);
+    }
+    return queue;
+}
+
+static inline QueueSetHandle_t xQueueCreateSet(UBaseType_t depth) {
+    return xQueueCreate(depth, 0);
+}
+
+static inline BaseType_t xQueueAddToSet(QueueSetMemberHandle_t member, QueueSetHandle_t set) {
+    if (set->member_count >= HOST_QUEUE_SET_MEMBERS) {
+        return pdFAIL;
+    }
+    set->members[set->member_count++] = member;
+    member->set = set;
+    return pdPASS;
+}
+
+static inline BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t timeout) {
+    (void)timeout;
+    if (queue->count >= queue->depth) {
+        return pdFAIL;
+    }
+    memcpy(&queue->ring[((queue->head + queue->count) % queue->depth) * queue->item_size], item, queue->item_size);
+    queue->count++;
+    if (queue->set != NULL) {
+        queue->set->count++;
+    }
+    return pdPASS;
+}
+
+static inline BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t timeout) {
+    (void)timeout;
+    if (queue->count == 0) {
+        return pdFAIL;
+    }
+    memcpy(item, &queue->ring[queue->head * queue->item_size], queue->item_size);
+    queue->head = (queue->head + 1) % queue->depth;
+    queue->count--;
+    return pdPASS;
+}
+
+/*
+* @brief takes one entry from the set and names a member that has an item, like the kernel the caller then has to
+* receive from that member (or any other one) to keep entries and items equal.
+*/
+static inline QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set, TickType_t timeout) {
+    (void)timeout;
+    if (set->count == 0) {
+        return NULL;
+    }
+    set->count--;
+    for (UBaseType_t i = 0; i < set->member_count; i++) {
+        if (set->members[i]->count > 0) {
+            return set->members[i];
+        }
+    }
+    return set->members[0];
+}
+
+static inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue->count;
+}
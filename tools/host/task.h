@@ -0,0 +1,17 @@
+#pragma once
+/*
+* @brief: Host stand-in for task.h, see FreeRTOS.h in this directory. There is one task, so suspending the
+* scheduler does nothing.
+*/
+static TickType_t host_tick_count = 0;
+
+static inline TickType_t xTaskGetTickCount(void) {
+    return host_tick_count;
+}
+
+static inline void vTaskSuspendAll(void) {
+}
+
+static inline BaseType_t xTaskResumeAll(void) {
+    return pdFALSE;
+}
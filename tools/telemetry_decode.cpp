@@ -0,0 +1,142 @@
+/*
+* @brief: Host side decoder for the binary telemetry stream written by vTelemetryTask.
+* Prints one CSV line per record: sequence,sensor,timestamp,raw,filtered. Bad frames and sequence gaps go to stderr.
+* timestamp is the monitor's kernel tick at publish, milliseconds since it started with the simulator's 1 kHz tick.
+*
+* Build: g++ -std=c++20 -O2 -I.. telemetry_decode.cpp -o telemetry_decode
+* Usage: telemetry_decode              read frames from stdin
+*        telemetry_decode <file|fifo>  read frames from a file or FIFO
+*        telemetry_decode -l <socket>  listen on a Unix domain socket and decode the first connection
+*/
+#include "telemetry_format.hpp"
+#include <cstdio>
+#include <cstring>
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+static const char* const SENSOR_NAMES[] = { "temperature", "light", "humidity" };
+
+struct DecodeStats {
+    unsigned long frames;
+    unsigned long records;
+    unsigned long bad_frames;
+    unsigned long lost_frames;
+};
+
+/*
+* @brief decode one COBS frame (delimiter already stripped) and print its records.
+*/
+static void handleFrame(const uint8_t* encoded, size_t len, DecodeStats& stats, bool& have_sequence, uint16_t& expected) {
+    uint8_t frame[TELEMETRY_MAX_ENCODED];
+    TelemetryRecord records[TELEMETRY_MAX_RECORDS];
+    uint16_t sequence;
+
+    size_t decoded = len <= sizeof(frame) ? cobsDecode(encoded, len, frame) : 0;
+    int count = decoded > 0 ? telemetryParseFrame(frame, decoded, records, &sequence) : -1;
+    if (count < 0) {
+        stats.bad_frames++;
+        fprintf(stderr, "bad frame (%zu bytes)\n", len);
+        return;
+    }
+    if (have_sequence && sequence != expected) {
+        uint16_t gap = static_cast<uint16_t>(sequence - expected);
+        stats.lost_frames += gap;
+        fprintf(stderr, "sequence gap: expected %u got %u\n", (unsigned)expected, (unsigned)sequence);
+    }
+    have_sequence = true;
+    expected = static_cast<uint16_t>(sequence + 1);
+    stats.frames++;
+
+    for (int i = 0; i < count; i++) {
+        const TelemetryRecord& r = records[i];
+        const char* name = r.sensor_id < sizeof(SENSOR_NAMES) / sizeof(SENSOR_NAMES[0]) ? SENSOR_NAMES[r.sensor_id] : "unknown";
+        printf("%u,%s,%lu,%.3f,%.3f\n", (unsigned)sequence, name, (unsigned long)r.timestamp, r.raw, r.filtered);
+        stats.records++;
+    }
+}
+
+/*
+* @brief split the byte stream on 0x00 delimiters. Oversized runs are dropped up to the next delimiter.
+*/
+template<typename ReadFn>
+static void decodeStream(ReadFn read_fn, DecodeStats& stats) {
+    uint8_t chunk[4096];
+    uint8_t pending[TELEMETRY_MAX_ENCODED];
+    size_t pending_len = 0;
+    bool overflow = false;
+    bool have_sequence = false;
+    uint16_t expected = 0;
+
+    while (1) {
+        long n = read_fn(chunk, sizeof(chunk));
+        if (n <= 0) {
+            break;
+        }
+        for (long i = 0; i < n; i++) {
+            if (chunk[i] == 0x00) {
+                if (overflow) {
+                    stats.bad_frames++;
+                }
+                else if (pending_len > 0) {
+                    handleFrame(pending, pending_len, stats, have_sequence, expected);
+                }
+                pending_len = 0;
+                overflow = false;
+            }
+            else if (pending_len < sizeof(pending)) {
+                pending[pending_len++] = chunk[i];
+            }
+            else {
+                overflow = true;
+            }
+        }
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char** argv) {
+    DecodeStats stats = { 0, 0, 0, 0 };
+
+    if (argc == 3 && strcmp(argv[1], "-l") == 0) {
+#if !defined(_WIN32)
+        int server = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, argv[2], sizeof(addr.sun_path) - 1);
+        unlink(argv[2]);
+        if (server < 0 || bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(server, 1) != 0) {
+            perror("listen");
+            return 1;
+        }
+        int client = accept(server, NULL, NULL);
+        if (client < 0) {
+            perror("accept");
+            return 1;
+        }
+        decodeStream([client](uint8_t* buf, size_t len) { return static_cast<long>(read(client, buf, len)); }, stats);
+        close(client);
+        close(server);
+        unlink(argv[2]);
+#else
+        fprintf(stderr, "Unix sockets are not supported on this platform\n");
+        return 1;
+#endif
+    }
+    else {
+        FILE* in = argc == 2 ? fopen(argv[1], "rb") : stdin;
+        if (in == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+        decodeStream([in](uint8_t* buf, size_t len) { return static_cast<long>(fread(buf, 1, len, in)); }, stats);
+        if (in != stdin) {
+            fclose(in);
+        }
+    }
+
+    fprintf(stderr, "frames: %lu records: %lu bad: %lu lost: %lu\n", stats.frames, stats.records, stats.bad_frames, stats.lost_frames);
+    return 0;
+}
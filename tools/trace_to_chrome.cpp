@@ -0,0 +1,462 @@
+/*
+* @brief: Host side converter from a Percepio trace recorder snapshot (written by vTraceDumpTask in a PLANT_MONITOR_TRACE=1
+* build) to Chrome trace event JSON, which both chrome://tracing and ui.perfetto.dev open.
+* Each task gets a track with its running intervals, kernel calls and the pipeline user events from trace_events.hpp
+* as instants. A "CPU" track shows which task held the processor over time.
+*
+* Only the snapshot format of the 4.x recorder with 8 bit object handles is understood. Events outside the
+* scheduling, queue/semaphore, delay and user event groups are kept as "kernel 0xNN" instants.
+*
+* Build: g++ -std=c++20 -O2 trace_to_chrome.cpp -o trace_to_chrome
+* Usage: trace_to_chrome <snapshot.bin> [out.json]   JSON goes to stdout when no output file is given
+*/
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Snapshot event codes, see trcKernelPort.h / trcSnapshotRecorder.h of the recorder
+static const uint8_t EV_TASK_READY = 0x02;
+static const uint8_t EV_TS_FIRST = 0x04; // ISR begin, ISR resume, task begin, task resume
+static const uint8_t EV_TS_LAST = 0x07;
+static const uint8_t EV_OBJCLOSE_FIRST = 0x08;
+static const uint8_t EV_KERNEL_FIRST = 0x18; // create ... delete, 8 codes per group, low 3 bits are the object class
+static const uint8_t EV_KERNEL_LAST = 0x87;
+static const uint8_t EV_TASK_DELAY_UNTIL = 0x88;
+static const uint8_t EV_TASK_DELAY = 0x89;
+static const uint8_t EV_TASK_PRIORITY_SET = 0x8D;
+static const uint8_t EV_TASK_PRIORITY_DISINHERIT = 0x8F;
+static const uint8_t EV_MEM_MALLOC_SIZE = 0x94;
+static const uint8_t EV_MEM_MALLOC_ADDR = 0x95;
+static const uint8_t EV_MEM_FREE_SIZE = 0x96;
+static const uint8_t EV_MEM_FREE_ADDR = 0x97;
+static const uint8_t EV_USER_FIRST = 0x98; // low 4 bits are the number of argument slots that follow
+static const uint8_t EV_USER_LAST = 0xA7;
+static const uint8_t EV_XTS8 = 0xA8;
+static const uint8_t EV_XTS16 = 0xA9;
+static const uint8_t EV_LOW_POWER_BEGIN = 0xAC;
+static const uint8_t EV_LOW_POWER_END = 0xAD;
+static const uint8_t EV_SYS_LAST = 0xAF;
+
+static const uint8_t CLASS_TASK = 3;
+static const uint8_t CLASS_ISR = 4;
+static const char* const CLASS_NAMES[] = { "queue", "semaphore", "mutex", "task", "isr", "timer", "eventgroup", "streambuffer", "messagebuffer" };
+static const char* const KERNEL_GROUP_NAMES[] = { "", "", "create", "send", "receive", "send_from_isr", "receive_from_isr",
+    "create_failed", "send_failed", "receive_failed", "send_from_isr_failed", "receive_from_isr_failed",
+    "receive_block", "send_block", "peek", "delete" };
+
+static const uint8_t START_MARKERS[12] = { 0x01, 0x02, 0x03, 0x04, 0x71, 0x72, 0x73, 0x74, 0xF1, 0xF2, 0xF3, 0xF4 };
+static const size_t ISR_TID_BASE = 1000;
+
+struct Snapshot {
+    std::vector<uint8_t> data;
+    uint32_t max_events = 0;
+    uint32_t next_free = 0;
+    bool buffer_full = false;
+    uint32_t frequency = 0;
+    size_t object_table = 0;
+    size_t symbol_table = 0;
+    size_t events = 0;
+
+    uint16_t u16(size_t offset) const {
+        return offset + 2 <= data.size() ? static_cast<uint16_t>(data[offset] | (data[offset + 1] << 8)) : 0;
+    }
+
+    uint32_t u32(size_t offset) const {
+        return offset + 4 <= data.size() ? static_cast<uint32_t>(u16(offset)) | (static_cast<uint32_t>(u16(offset + 2)) << 16) : 0;
+    }
+
+    /*
+    * @brief offset just past the first 4 byte aligned `marker` at or after `from`, 0 if there is none.
+    */
+    size_t findMarker(uint32_t marker, size_t from) const {
+        for (size_t offset = (from + 3) & ~static_cast<size_t>(3); offset + 4 <= data.size(); offset += 4) {
+            if (u32(offset) == marker) {
+                return offset + 4;
+            }
+        }
+        return 0;
+    }
+
+    /*
+    * @brief name of object `handle` of class `cls` from the object property table, empty if unknown.
+    */
+    std::string objectName(uint8_t cls, uint8_t handle) const {
+        uint32_t classes = u32(object_table);
+        if (cls >= classes || handle == 0) {
+            return "";
+        }
+        // NumberOfObjectsPerClass, NameLengthPerClass and TotalPropertyBytesPerClass are padded to 4 bytes, StartIndexOfClass to 2 entries
+        const size_t padded = 4 * ((classes + 3) / 4);
+        const size_t count_at = object_table + 8;
+        const size_t name_len_at = count_at + padded;
+        const size_t total_at = name_len_at + padded;
+        const size_t start_at = total_at + padded;
+        const size_t objects_at = start_at + 2 * 2 * ((classes + 1) / 2);
+        if (objects_at >= data.size() || handle > data[count_at + cls]) {
+            return "";
+        }
+        size_t entry = objects_at + u16(start_at + 2 * cls) + static_cast<size_t>(handle - 1) * data[total_at + cls];
+        std::string name;
+        for (size_t i = 0; i < data[name_len_at + cls] && entry + i < data.size() && data[entry + i] != 0; i++) {
+            name += static_cast<char>(data[entry + i]);
+        }
+        return name;
+    }
+
+    /*
+    * @brief string `index` from the symbol table. Entries are u16 next-in-chain, u16 channel symbol, then the string.
+    */
+    std::string symbol(uint16_t index, uint16_t* channel = NULL) const {
+        const size_t entry = symbol_table + 8 + index;
+        if (channel != NULL) {
+            *channel = u16(entry + 2);
+        }
+        std::string text;
+        for (size_t i = entry + 4; i < data.size() && data[i] != 0; i++) {
+            text += static_cast<char>(data[i]);
+        }
+        return text;
+    }
+
+    const uint8_t* event(uint32_t index) const {
+        return &data[events + 4 * static_cast<size_t>(index % max_events)];
+    }
+};
+
+static bool loadSnapshot(const char* path, Snapshot& snapshot) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        snapshot.data.insert(snapshot.data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+
+    if (snapshot.data.size() < 64 || memcmp(snapshot.data.data(), START_MARKERS, sizeof(START_MARKERS)) != 0) {
+        fprintf(stderr, "%s: not a trace recorder snapshot (start markers missing)\n", path);
+        return false;
+    }
+    snapshot.max_events = snapshot.u32(24);
+    snapshot.next_free = snapshot.u32(28);
+    snapshot.buffer_full = snapshot.u32(32) != 0;
+    snapshot.frequency = snapshot.u32(36);
+
+    size_t marker0 = snapshot.findMarker(0xF0F0F0F0u, 40);
+    size_t marker1 = marker0 ? snapshot.findMarker(0xF1F1F1F1u, marker0) : 0;
+    size_t marker2 = marker1 ? snapshot.findMarker(0xF2F2F2F2u, marker1) : 0;
+    size_t marker3 = marker2 ? snapshot.findMarker(0xF3F3F3F3u, marker2) : 0;
+    if (marker3 == 0) {
+        fprintf(stderr, "%s: debug markers not found, truncated dump?\n", path);
+        return false;
+    }
+    if (snapshot.u32(marker0) != 0) {
+        fprintf(stderr, "%s: 16 bit object handles are not supported\n", path);
+        return false;
+    }
+    snapshot.object_table = marker0 + 4; // skip isUsing16bitHandles
+    snapshot.symbol_table = marker1;
+    snapshot.events = marker3;
+    if (snapshot.max_events == 0 || snapshot.events + 4 * static_cast<size_t>(snapshot.max_events) > snapshot.data.size()) {
+        fprintf(stderr, "%s: event buffer (%lu events) runs past the end of the file\n", path, (unsigned long)snapshot.max_events);
+        return false;
+    }
+    return true;
+}
+
+static std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+            out += buf;
+        }
+        else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+/*
+* @brief expand a vTracePrintF format with its packed arguments. 8 bit arguments (%bd) are byte aligned,
+* 16 bit ones (%hd) 2 byte aligned, everything else is a 32 bit slot. %s arguments are symbol table indices.
+*/
+static std::string formatUserEvent(const Snapshot& snapshot, const std::string& format, const uint8_t* args, size_t args_len) {
+    std::string out;
+    size_t pos = 0;
+    char buf[32];
+    for (size_t i = 0; i < format.size(); i++) {
+        if (format[i] != '%' || i + 1 >= format.size()) {
+            out += format[i];
+            continue;
+        }
+        char spec = format[++i];
+        size_t width = 4;
+        if (spec == 'b' || spec == 'h') {
+            width = spec == 'b' ? 1 : 2;
+            spec = i + 1 < format.size() ? format[++i] : 'd';
+        }
+        if (spec == '%') {
+            out += '%';
+            continue;
+        }
+        if (spec == 's') {
+            width = 2;
+        }
+        pos = (pos + width - 1) & ~(width - 1);
+        if (pos + width > args_len) {
+            out += "?";
+            continue;
+        }
+        uint32_t raw = width == 1 ? args[pos] : width == 2 ? static_cast<uint32_t>(args[pos] | (args[pos + 1] << 8)) :
+            static_cast<uint32_t>(args[pos]) | (static_cast<uint32_t>(args[pos + 1]) << 8) |
+            (static_cast<uint32_t>(args[pos + 2]) << 16) | (static_cast<uint32_t>(args[pos + 3]) << 24);
+        pos += width;
+        if (spec == 's') {
+            out += snapshot.symbol(static_cast<uint16_t>(raw));
+            continue;
+        }
+        int32_t value = width == 1 ? static_cast<int8_t>(raw) : width == 2 ? static_cast<int16_t>(raw) : static_cast<int32_t>(raw);
+        switch (spec) {
+        case 'u':
+            snprintf(buf, sizeof(buf), "%lu", (unsigned long)raw);
+            break;
+        case 'x':
+        case 'X':
+            snprintf(buf, sizeof(buf), "0x%lx", (unsigned long)raw);
+            break;
+        default:
+            snprintf(buf, sizeof(buf), "%ld", (long)value);
+            break;
+        }
+        out += buf;
+    }
+    return out;
+}
+
+class ChromeTraceWriter {
+public:
+    ChromeTraceWriter(FILE* out, uint32_t frequency) : m_out(out), m_frequency(frequency) {
+        fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", m_out);
+        metadata(0, "CPU");
+    }
+
+    ~ChromeTraceWriter() {
+        fputs("\n]}\n", m_out);
+    }
+
+    void metadata(size_t tid, const std::string& name) {
+        separator();
+        fprintf(m_out, "{\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}", tid, jsonEscape(name).c_str());
+    }
+
+    void slice(size_t tid, const std::string& name, uint64_t start, uint64_t end) {
+        separator();
+        fprintf(m_out, "{\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f}",
+            tid, jsonEscape(name).c_str(), micros(start), micros(end) - micros(start));
+    }
+
+    void instant(size_t tid, const std::string& category, const std::string& name, uint64_t time) {
+        separator();
+        fprintf(m_out, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%zu,\"cat\":\"%s\",\"name\":\"%s\",\"ts\":%.3f}",
+            tid, jsonEscape(category).c_str(), jsonEscape(name).c_str(), micros(time));
+    }
+
+private:
+    void separator() {
+        if (m_events++ > 0) {
+            fputs(",\n", m_out);
+        }
+    }
+
+    double micros(uint64_t time) const {
+        return static_cast<double>(time) * 1e6 / m_frequency;
+    }
+
+    FILE* m_out;
+    uint32_t m_frequency;
+    size_t m_events = 0;
+};
+
+struct ConvertStats {
+    unsigned long events;
+    unsigned long switches;
+    unsigned long kernel_calls;
+    unsigned long user_events;
+    unsigned long unknown;
+};
+
+/*
+* @brief walk the ring buffer from its oldest event, rebuilding absolute time from the per event deltas.
+* Deltas too large for an event's dts field arrive as a preceding XTS8/XTS16 event carrying the upper bits.
+*/
+static ConvertStats convert(const Snapshot& snapshot, ChromeTraceWriter& writer) {
+    ConvertStats stats = {};
+    const uint32_t count = snapshot.buffer_full ? snapshot.max_events : snapshot.next_free;
+    const uint32_t first = snapshot.buffer_full ? snapshot.next_free : 0;
+    uint64_t now = 0;
+    uint32_t extended = 0; // upper timestamp bits from the last XTS event
+    bool named[2 * ISR_TID_BASE] = {};
+    size_t running = 0; // tid on the CPU, 0 before the first switch
+    std::string running_name;
+    uint64_t running_since = 0;
+
+    auto advance = [&](uint32_t dts) {
+        now += extended + dts;
+        extended = 0;
+    };
+    auto trackName = [&](size_t tid, uint8_t cls, uint8_t handle) {
+        std::string name = snapshot.objectName(cls, handle);
+        if (name.empty()) {
+            name = std::string(CLASS_NAMES[cls]) + "#" + std::to_string(handle);
+        }
+        if (tid < sizeof(named) / sizeof(named[0]) && !named[tid]) {
+            named[tid] = true;
+            writer.metadata(tid, name);
+        }
+        return name;
+    };
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* e = snapshot.event(first + i);
+        const uint8_t code = e[0];
+        if (code == 0) {
+            continue;
+        }
+        stats.events++;
+
+        if (code == EV_XTS8) {
+            extended = (static_cast<uint32_t>(e[1]) << 24) | (static_cast<uint32_t>(e[2] | (e[3] << 8)) << 8);
+        }
+        else if (code == EV_XTS16) {
+            extended = static_cast<uint32_t>(e[2] | (e[3] << 8)) << 16;
+        }
+        else if (code >= EV_TS_FIRST && code <= EV_TS_LAST) {
+            advance(static_cast<uint32_t>(e[2] | (e[3] << 8)));
+            const bool isr = code < EV_TS_FIRST + 2;
+            const size_t tid = isr ? ISR_TID_BASE + e[1] : e[1];
+            std::string name = trackName(tid, isr ? CLASS_ISR : CLASS_TASK, e[1]);
+            if (running != 0) {
+                writer.slice(running, running_name, running_since, now);
+                writer.slice(0, running_name, running_since, now);
+            }
+            running = tid;
+            running_name = name;
+            running_since = now;
+            stats.switches++;
+        }
+        else if (code == EV_TASK_READY) {
+            advance(e[2]);
+            trackName(e[1], CLASS_TASK, e[1]);
+            writer.instant(e[1], "kernel", "ready", now);
+        }
+        else if (code >= EV_OBJCLOSE_FIRST && code < EV_KERNEL_FIRST) {
+            // object close name/properties, no timestamp
+        }
+        else if (code <= EV_KERNEL_LAST) {
+            advance(e[2]);
+            const uint8_t cls = code & 0x07;
+            std::string object = snapshot.objectName(cls, e[1]);
+            std::string name = std::string(KERNEL_GROUP_NAMES[(code - EV_OBJCLOSE_FIRST) / 8]) + " " + CLASS_NAMES[cls] +
+                (object.empty() ? "#" + std::to_string(e[1]) : " " + object);
+            writer.instant(running, "kernel", name, now);
+            stats.kernel_calls++;
+        }
+        else if (code == EV_TASK_DELAY || code == EV_TASK_DELAY_UNTIL) {
+            advance(e[1]);
+            std::string name = std::string(code == EV_TASK_DELAY ? "delay " : "delay_until ") + std::to_string(e[2] | (e[3] << 8));
+            writer.instant(running, "kernel", name, now);
+            stats.kernel_calls++;
+        }
+        else if (code >= EV_TASK_PRIORITY_SET && code <= EV_TASK_PRIORITY_DISINHERIT) {
+            advance(e[3]);
+            writer.instant(running, "kernel", "priority " + std::to_string(e[2]) + " task#" + std::to_string(e[1]), now);
+            stats.kernel_calls++;
+        }
+        else if (code == EV_MEM_MALLOC_SIZE || code == EV_MEM_FREE_SIZE) {
+            advance(e[1]);
+            std::string name = std::string(code == EV_MEM_MALLOC_SIZE ? "malloc " : "free ") + std::to_string(e[2] | (e[3] << 8));
+            writer.instant(running, "heap", name, now);
+        }
+        else if (code == EV_MEM_MALLOC_ADDR || code == EV_MEM_FREE_ADDR) {
+            // address half of a heap event, no timestamp
+        }
+        else if (code >= EV_USER_FIRST && code <= EV_USER_LAST) {
+            advance(e[1]);
+            const uint32_t slots = code - EV_USER_FIRST;
+            uint8_t args[4 * 15];
+            for (uint32_t s = 0; s < slots; s++) {
+                memcpy(args + 4 * s, snapshot.event(first + i + 1 + s), 4);
+            }
+            i += slots;
+            uint16_t channel = 0;
+            std::string format = snapshot.symbol(static_cast<uint16_t>(e[2] | (e[3] << 8)), &channel);
+            std::string category = channel != 0 ? snapshot.symbol(channel) : "user";
+            writer.instant(running, category, category + ": " + formatUserEvent(snapshot, format, args, 4 * slots), now);
+            stats.user_events++;
+        }
+        else if (code == EV_LOW_POWER_BEGIN || code == EV_LOW_POWER_END) {
+            advance(e[1]);
+            writer.instant(0, "power", code == EV_LOW_POWER_BEGIN ? "low power begin" : "low power end", now);
+        }
+        else if (code <= EV_SYS_LAST) {
+            // handle extensions, dummy and being-written markers
+        }
+        else {
+            // timer, event group and stream buffer calls mostly use the kernel call layout
+            advance(e[2]);
+            char name[24];
+            snprintf(name, sizeof(name), "kernel 0x%02X", (unsigned)code);
+            writer.instant(running, "kernel", name, now);
+            stats.unknown++;
+        }
+    }
+    if (running != 0) {
+        writer.slice(running, running_name, running_since, now);
+        writer.slice(0, running_name, running_since, now);
+    }
+    return stats;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s <snapshot.bin> [out.json]\n", argv[0]);
+        return 2;
+    }
+    Snapshot snapshot;
+    if (!loadSnapshot(argv[1], snapshot)) {
+        return 1;
+    }
+    if (snapshot.frequency == 0) {
+        fprintf(stderr, "timestamp frequency not recorded, assuming 100 kHz\n");
+        snapshot.frequency = 100000;
+    }
+    FILE* out = argc == 3 ? fopen(argv[2], "w") : stdout;
+    if (out == NULL) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    ConvertStats stats;
+    {
+        ChromeTraceWriter writer(out, snapshot.frequency);
+        stats = convert(snapshot, writer);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    fprintf(stderr, "%lu events: %lu context switches, %lu kernel calls, %lu user events, %lu unrecognised\n",
+        stats.events, stats.switches, stats.kernel_calls, stats.user_events, stats.unknown);
+    return 0;
+}
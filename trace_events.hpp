@@ -0,0 +1,87 @@
+#pragma once
+extern "C" {
+    #include "FreeRTOS.h"
+    #include "task.h"
+}
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/*
+* @brief: Pipeline user events for the Percepio trace recorder. Build with PLANT_MONITOR_TRACE=1 (FreeRTOSConfig.h)
+* and the recorder logs the scheduler plus these events into its snapshot ring buffer, otherwise every hook is an empty inline.
+* The recorder is configured without float support, so readings are logged in hundredths.
+* A snapshot written by traceDumpSnapshot() is converted to Chrome trace / Perfetto JSON by tools/trace_to_chrome.cpp.
+*/
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+#if ( TRC_CFG_RECORDER_MODE != TRC_RECORDER_MODE_SNAPSHOT )
+#error "WIN32.vcxproj builds only the snapshot recorder, set TRC_CFG_RECORDER_MODE to TRC_RECORDER_MODE_SNAPSHOT"
+#endif
+
+struct TraceChannels {
+    traceString sensor;
+    traceString raw;
+    traceString filter;
+};
+
+inline TraceChannels trace_channels;
+
+inline int32_t traceHundredths(float value) {
+    return static_cast<int32_t>(value >= 0.0f ? value * 100.0f + 0.5f : value * 100.0f - 0.5f);
+}
+
+/*
+* @brief start recording. Call before any task or queue is created so the recorder sees their names.
+*/
+inline void traceStart() {
+    vTraceEnable(TRC_START);
+    trace_channels.sensor = xTraceRegisterString("sensor");
+    trace_channels.raw = xTraceRegisterString("raw");
+    trace_channels.filter = xTraceRegisterString("filter");
+}
+
+inline void traceSensorRead(uint8_t type, float value) {
+    vTracePrintF(trace_channels.sensor, "read type %d value %d", type, traceHundredths(value));
+}
+
+inline void traceRawSend(uint8_t type, size_t lane) {
+    vTracePrintF(trace_channels.raw, "send type %d lane %d", type, static_cast<int32_t>(lane));
+}
+
+inline void traceRawReceive(uint8_t type, size_t lane, uint32_t waited) {
+    vTracePrintF(trace_channels.raw, "recv type %d lane %d waited %d", type, static_cast<int32_t>(lane), static_cast<int32_t>(waited));
+}
+
+inline void traceFilterUpdate(uint8_t type, float filtered) {
+    vTracePrintF(trace_channels.filter, "update type %d filtered %d", type, traceHundredths(filtered));
+}
+
+/*
+* @brief write the whole recorder data block to `path`. The scheduler is suspended during the copy so tasks can't
+* move the ring head underneath it, events from the tick interrupt may still tear the newest record.
+* @return false if the file couldn't be written
+*/
+inline bool traceDumpSnapshot(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    const size_t size = uiTraceGetTraceBufferSize();
+    vTaskSuspendAll();
+    bool ok = fwrite(vTraceGetTraceBuffer(), 1, size, file) == size;
+    xTaskResumeAll();
+    fclose(file);
+    return ok;
+}
+
+#else
+
+inline void traceStart() {}
+inline void traceSensorRead(uint8_t, float) {}
+inline void traceRawSend(uint8_t, size_t) {}
+inline void traceRawReceive(uint8_t, size_t, uint32_t) {}
+inline void traceFilterUpdate(uint8_t, float) {}
+inline bool traceDumpSnapshot(const char*) { return false; }
+
+#endif
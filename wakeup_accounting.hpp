@@ -0,0 +1,153 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+* @brief: WakeupAccounting counts how often the kernel and the tasks wake up, to check the pipeline only runs when it has work.
+*   tick()       - from the tick hook, a tick inside a suppressed sleep window is counted separately since a tickless port skips it
+*   switchedIn() - from traceTASK_SWITCHED_IN, a switch to a different non-idle task is one wakeup of that task
+*   sleepBegin/sleepEnd() - around the tickless sleep of the idle task
+* Times come from the run time counter. The hooks run inside the scheduler so they only touch atomics and never block,
+* report() is for a single reader task and turns the counters into per second rates over a window.
+*/
+template<size_t MaxTasks = 16>
+class WakeupAccounting {
+public:
+    struct TaskRate {
+        void* task;
+        float wakeups;
+    };
+
+    struct Report {
+        float ticks;       // tick interrupts per second that actually woke the CPU
+        float suppressed;  // ticks per second that fell inside a tickless sleep
+        float wakeups;     // task wakeups per second, all tasks
+        float idle;        // fraction of time in the idle task
+        float asleep;      // fraction of time in tickless sleep, part of idle
+        size_t tasks;
+        std::array<TaskRate, MaxTasks> task_rates;
+    };
+
+    explicit WakeupAccounting(uint32_t counter_hz) : m_counter_hz(counter_hz) {}
+
+    void tick() {
+        if (m_sleeping.load(std::memory_order_relaxed)) {
+            m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            m_ticks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void switchedIn(void* task, void* idle, uint64_t now) {
+        void* previous = m_current.load(std::memory_order_relaxed);
+        if (task == previous) {
+            return; // the running task was picked again, nothing woke up
+        }
+        if (previous != NULL && previous == idle) {
+            m_idle_time.fetch_add(now - m_since.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        m_since.store(now, std::memory_order_relaxed);
+        m_current.store(task, std::memory_order_relaxed);
+        if (task == idle) {
+            return;
+        }
+        for (size_t i = 0; i < MaxTasks; i++) {
+            void* slot = m_tasks[i].task.load(std::memory_order_relaxed);
+            if (slot == NULL) {
+                m_tasks[i].task.store(task, std::memory_order_relaxed); // hooks are serialised by the scheduler, one writer
+                slot = task;
+            }
+            if (slot == task) {
+                m_tasks[i].wakeups.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+        m_wakeups.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void sleepBegin(uint64_t now) {
+        m_sleep_started = now;
+        m_sleeping.store(true, std::memory_order_relaxed);
+    }
+
+    void sleepEnd(uint64_t now) {
+        m_sleeping.store(false, std::memory_order_relaxed);
+        m_sleep_time.fetch_add(now - m_sleep_started, std::memory_order_relaxed);
+    }
+
+    /*
+    * @brief rates over the last completed window of `window` counter units, recomputed once a window has passed.
+    * @param idle the idle task, to include an idle interval that is still running
+    */
+    const Report& report(uint64_t now, void* idle, uint64_t window) {
+        if (now - m_window_start < window) {
+            return m_report;
+        }
+        const float seconds = static_cast<float>(now - m_window_start) / m_counter_hz;
+        uint64_t idle_time = m_idle_time.load(std::memory_order_relaxed);
+        if (m_current.load(std::memory_order_relaxed) == idle) {
+            idle_time += now - m_since.load(std::memory_order_relaxed);
+        }
+        Counters counters = {
+            m_ticks.load(std::memory_order_relaxed),
+            m_suppressed.load(std::memory_order_relaxed),
+            m_wakeups.load(std::memory_order_relaxed),
+            idle_time,
+            m_sleep_time.load(std::memory_order_relaxed)
+        };
+        const float elapsed = static_cast<float>(now - m_window_start);
+        m_report.ticks = (counters.ticks - m_last.ticks) / seconds;
+        m_report.suppressed = (counters.suppressed - m_last.suppressed) / seconds;
+        m_report.wakeups = (counters.wakeups - m_last.wakeups) / seconds;
+        m_report.idle = static_cast<float>(counters.idle_time - m_last.idle_time) / elapsed;
+        m_report.asleep = static_cast<float>(counters.sleep_time - m_last.sleep_time) / elapsed;
+        m_report.tasks = 0;
+        for (size_t i = 0; i < MaxTasks; i++) {
+            void* task = m_tasks[i].task.load(std::memory_order_relaxed);
+            if (task == NULL) {
+                break;
+            }
+            uint32_t wakeups = m_tasks[i].wakeups.load(std::memory_order_relaxed);
+            m_report.task_rates[m_report.tasks++] = { task, (wakeups - m_last_task_wakeups[i]) / seconds };
+            m_last_task_wakeups[i] = wakeups;
+        }
+        m_last = counters;
+        m_window_start = now;
+        return m_report;
+    }
+
+private:
+    struct Counters {
+        uint32_t ticks;
+        uint32_t suppressed;
+        uint32_t wakeups;
+        uint64_t idle_time;
+        uint64_t sleep_time;
+    };
+
+    struct TaskSlot {
+        std::atomic<void*> task{ NULL };
+        std::atomic<uint32_t> wakeups{ 0 };
+    };
+
+    const uint32_t m_counter_hz;
+    std::atomic<uint32_t> m_ticks{ 0 };
+    std::atomic<uint32_t> m_suppressed{ 0 };
+    std::atomic<uint32_t> m_wakeups{ 0 };
+    std::atomic<uint64_t> m_idle_time{ 0 };
+    std::atomic<uint64_t> m_sleep_time{ 0 };
+    std::atomic<bool> m_sleeping{ false };
+    uint64_t m_sleep_started = 0; // idle task only
+    std::atomic<void*> m_current{ NULL };
+    std::atomic<uint64_t> m_since{ 0 };
+    std::array<TaskSlot, MaxTasks> m_tasks;
+
+    // reader side
+    uint64_t m_window_start = 0;
+    Counters m_last = {};
+    std::array<uint32_t, MaxTasks> m_last_task_wakeups{};
+    Report m_report = {};
+};